@@ -1,7 +1,11 @@
 #include "MainWindow.h"
 
+#include "core/BackupQueue.h"
+#include "core/BackupRetention.h"
 #include "core/LosslessJsonDocument.h"
 #include "core/SaveCache.h"
+#include "core/SavePrefetcher.h"
+#include "core/SaveSession.h"
 #include "inventory/InventoryEditorPage.h"
 #include "inventory/InventoryGridWidget.h"
 #include "inventory/KnownTechnologyPage.h"
@@ -14,6 +18,7 @@
 #include "ui/BackupsPage.h"
 #include "ui/JsonExplorerPage.h"
 #include "ui/MaterialLookupDialog.h"
+#include "ui/SaveDiffDialog.h"
 #include "ui/WelcomePage.h"
 #include "ui/LoadingOverlay.h"
 #include "frigate/FrigateManagerPage.h"
@@ -25,12 +30,14 @@
 #include <QDebug>
 #include <QDialog>
 #include <QDialogButtonBox>
+#include <QDir>
 #include <QFileSystemWatcher>
 #include <QDesktopServices>
 #include <QFile>
 #include <QFileInfo>
 #include <QFileDialog>
 #include <QFrame>
+#include <QKeySequence>
 #include <QLabel>
 #include <QListWidget>
 #include <QMenuBar>
@@ -41,6 +48,7 @@
 #include <QStyledItemDelegate>
 #include <QStackedWidget>
 #include <QStatusBar>
+#include <QTemporaryDir>
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
 #include <QVBoxLayout>
@@ -103,6 +111,14 @@ private:
     int perLevelIndent_ = 0;
 };
 
+template <typename Page>
+void dropPendingFlag(Page *page, const QWidget *activePage)
+{
+    if (page != activePage && page->hasUnsavedChanges()) {
+        page->clearLoadedSave();
+    }
+}
+
 }
 
 MainWindow::MainWindow(QWidget *parent)
@@ -327,8 +343,73 @@ void MainWindow::buildUi()
     connect(welcomePage_, &WelcomePage::saveChangesRequested, this, &MainWindow::saveChanges);
     connect(welcomePage_, &WelcomePage::syncOtherSaveRequested, this, &MainWindow::syncOtherSave);
     connect(welcomePage_, &WelcomePage::undoSyncRequested, this, &MainWindow::undoSync);
+    prefetcher_ = new SavePrefetcher(this);
+    connect(welcomePage_, &WelcomePage::selectionChanged, this, &MainWindow::prefetchSelectedSave);
 
+    backupQueue_ = new BackupQueue(this);
+    connect(backupQueue_, &BackupQueue::backupCreated, this, [this]() {
+        if (stackedPages_->currentWidget() == backupsPage_) {
+            refreshBackupsPage();
+        }
+    });
+    connect(backupQueue_, &BackupQueue::backupFailed, this, [](const QString &path, const QString &error) {
+        if (!error.isEmpty()) {
+            qWarning() << "Backup failed:" << path << error;
+        }
+    });
+    connect(backupQueue_, &BackupQueue::restoreFinished, this,
+            [this](const QString &targetPath, bool ok, const QString &error) {
+        if (!ok) {
+            setStatus(error.isEmpty() ? tr("Restore failed.") : error);
+            return;
+        }
+        setStatus(tr("Backup restored to %1").arg(QFileInfo(targetPath).fileName()));
+    });
+    connect(backupQueue_, &BackupQueue::pruneFinished, this, [this](const RetentionReport &report) {
+        if (report.dryRun) {
+            if (report.removed.isEmpty()) {
+                setStatus(tr("No backups are due for cleanup."));
+                return;
+            }
+            const QString question = tr("Remove %1 of %2 backups and reclaim %3?")
+                                         .arg(report.removed.size())
+                                         .arg(report.removed.size() + report.keptCount)
+                                         .arg(BackupManager::formatSize(report.reclaimedBytes));
+            if (QMessageBox::question(this, tr("Clean Up Backups"), question,
+                                      QMessageBox::Yes | QMessageBox::No, QMessageBox::No)
+                == QMessageBox::Yes) {
+                backupQueue_->requestRemove(backupManager_, report.removed);
+            }
+            return;
+        }
+        if (!report.errorMessage.isEmpty()) {
+            qWarning() << "Backup cleanup:" << report.errorMessage;
+        }
+        if (!report.removed.isEmpty()) {
+            setStatus(tr("Removed %1 old backups, reclaimed %2.")
+                          .arg(report.removed.size())
+                          .arg(BackupManager::formatSize(report.reclaimedBytes)));
+            if (stackedPages_->currentWidget() == backupsPage_) {
+                refreshBackupsPage();
+            }
+        }
+    });
+    connect(backupsPage_, &BackupsPage::pruneRequested, this, [this]() {
+        backupQueue_->requestPrune(backupManager_, RetentionPolicy(), true);
+    });
     connect(backupsPage_, &BackupsPage::refreshRequested, this, &MainWindow::refreshBackupsPage);
+    connect(backupsPage_, &BackupsPage::rescanRequested, this, [this]() {
+        setStatus(tr("Rescanning backups..."));
+        backupQueue_->requestRescan(backupManager_);
+    });
+    connect(backupQueue_, &BackupQueue::rescanFinished, this, [this](bool ok, const QString &error) {
+        if (!ok) {
+            setStatus(error.isEmpty() ? tr("Unable to rebuild the backup index.") : error);
+        } else {
+            setStatus(tr("Backup index rebuilt."));
+        }
+        refreshBackupsPage();
+    });
     connect(backupsPage_, &BackupsPage::openFolderRequested, this, [](const QString &path) {
         QDesktopServices::openUrl(QUrl::fromLocalFile(path));
     });
@@ -349,17 +430,41 @@ void MainWindow::buildUi()
             return;
         }
 
-        const SaveSlot *slot = findSlotForPath(targetPath);
-        QString error;
-        if (QFileInfo::exists(targetPath)) {
-            backupManager_.createBackup(targetPath, slot, QStringLiteral("pre-restore"), nullptr, &error);
+        setStatus(tr("Restoring backup to %1...").arg(QFileInfo(targetPath).fileName()));
+        backupQueue_->requestRestore(backupManager_, entry, targetPath, saveSlots_);
+    });
+    connect(backupsPage_, &BackupsPage::compareRequested, this, [this](const BackupEntry &entry) {
+        const QString livePath = entry.sourcePath;
+        if (livePath.isEmpty() || !QFileInfo::exists(livePath)) {
+            setStatus(tr("The save this backup was taken from no longer exists."));
+            return;
         }
-        if (!backupManager_.restoreBackup(entry, targetPath, &error)) {
-            setStatus(error.isEmpty() ? tr("Restore failed.") : error);
+        if (!entry.inBlobStore) {
+            showSaveDiff(entry.backupPath, livePath);
             return;
         }
-        lastBackupMtime_.remove(targetPath);
-        setStatus(tr("Backup restored to %1").arg(QFileInfo(targetPath).fileName()));
+        // Store-backed backups have no .hg of their own; the queue rebuilds
+        // one off the UI thread for the dialog to load.
+        if (!compareDir_) {
+            compareDir_ = std::make_unique<QTemporaryDir>();
+        }
+        const QString folder = compareDir_->filePath(QString::number(++compareCount_));
+        if (!compareDir_->isValid() || !QDir().mkpath(folder)) {
+            setStatus(tr("Unable to read the backup."));
+            return;
+        }
+        const QString saveName = entry.saveName.isEmpty() ? QStringLiteral("backup.hg") : entry.saveName;
+        setStatus(tr("Reading backup..."));
+        backupQueue_->requestExtract(backupManager_, entry, QDir(folder).filePath(saveName));
+    });
+    connect(backupQueue_, &BackupQueue::extractFinished, this,
+            [this](const BackupEntry &entry, const QString &targetPath, bool ok, const QString &error) {
+        if (ok) {
+            showSaveDiff(targetPath, entry.sourcePath);
+        } else {
+            setStatus(error.isEmpty() ? tr("Unable to read the backup.") : error);
+        }
+        QDir(QFileInfo(targetPath).absolutePath()).removeRecursively();
     });
 
     connect(jsonPage_, &JsonExplorerPage::statusMessage, this, &MainWindow::setStatus);
@@ -373,7 +478,43 @@ void MainWindow::buildUi()
     connect(knownTechnologyPage_, &KnownTechnologyPage::statusMessage, this, &MainWindow::setStatus);
     connect(knownProductPage_, &KnownProductPage::statusMessage, this, &MainWindow::setStatus);
 
+    session_ = new SaveSession(this);
+    auto reportEdit = [this](QWidget *page) {
+        return [this, page](const QVariantList &path) {
+            session_->notifyEdited(page, path);
+        };
+    };
+    connect(jsonPage_, &JsonExplorerPage::documentEdited, this, reportEdit(jsonPage_));
+    connect(inventoryPage_, &InventoryEditorPage::documentEdited, this, reportEdit(inventoryPage_));
+    connect(currenciesPage_, &InventoryEditorPage::documentEdited, this, reportEdit(currenciesPage_));
+    connect(expeditionPage_, &InventoryEditorPage::documentEdited, this, reportEdit(expeditionPage_));
+    connect(storageManagerPage_, &InventoryEditorPage::documentEdited, this,
+            reportEdit(storageManagerPage_));
+    connect(settlementPage_, &SettlementManagerPage::documentEdited, this, reportEdit(settlementPage_));
+    connect(shipManagerPage_, &ShipManagerPage::documentEdited, this, reportEdit(shipManagerPage_));
+    connect(frigateManagerPage_, &FrigateManagerPage::documentEdited, this,
+            reportEdit(frigateManagerPage_));
+    connect(knownTechnologyPage_, &KnownTechnologyPage::documentEdited, this,
+            reportEdit(knownTechnologyPage_));
+    connect(knownProductPage_, &KnownProductPage::documentEdited, this, reportEdit(knownProductPage_));
+    // Pages share the session's lossless document, so an edit elsewhere only
+    // leaves their Qt view behind; they refresh from the session when reopened.
+    connect(session_, &SaveSession::documentChanged, this,
+            [this](QObject *origin, const QVariantList &) {
+                for (QWidget *page : editorPages()) {
+                    if (page != origin) {
+                        stalePages_.insert(page);
+                    }
+                }
+            });
+    connect(session_, &SaveSession::sessionReset, this, [this]() {
+        const QList<QWidget *> pages = editorPages();
+        stalePages_ = QSet<QWidget *>(pages.begin(), pages.end());
+    });
+    connect(session_, &SaveSession::historyChanged, this, &MainWindow::updateHistoryActions);
+
     refreshSaveSlots();
+    backupQueue_->requestPrune(backupManager_, RetentionPolicy(), false);
     sectionTree_->setCurrentItem(homeItem);
 
     (void)QtConcurrent::run([]() {
@@ -397,6 +538,14 @@ void MainWindow::buildMenus()
     fileMenu->addSeparator();
     QAction *exitAction = fileMenu->addAction(tr("Exit"));
 
+    auto *editMenu = menuBar()->addMenu(tr("Edit"));
+    undoAction_ = editMenu->addAction(tr("Undo"));
+    undoAction_->setShortcut(QKeySequence::Undo);
+    undoAction_->setEnabled(false);
+    redoAction_ = editMenu->addAction(tr("Redo"));
+    redoAction_->setShortcut(QKeySequence::Redo);
+    redoAction_->setEnabled(false);
+
     auto *viewMenu = menuBar()->addMenu(tr("View"));
     QAction *expandAction = viewMenu->addAction(tr("Expand All"));
     QAction *collapseAction = viewMenu->addAction(tr("Collapse All"));
@@ -411,6 +560,8 @@ void MainWindow::buildMenus()
 
     connect(openAction, &QAction::triggered, this, &MainWindow::browseForSaveDirectory);
     connect(saveAction_, &QAction::triggered, this, &MainWindow::saveChanges);
+    connect(undoAction_, &QAction::triggered, this, &MainWindow::undoEdit);
+    connect(redoAction_, &QAction::triggered, this, &MainWindow::redoEdit);
     connect(saveAsAction, &QAction::triggered, this, [this]() {
         if (!ensureSaveLoaded()) {
             return;
@@ -542,6 +693,19 @@ void MainWindow::loadSelectedSave()
     loadSavePath(path);
 }
 
+void MainWindow::prefetchSelectedSave()
+{
+    QString path = welcomePage_->selectedSavePath();
+    if (path.isEmpty()) {
+        path = resolveLatestSavePath(welcomePage_->selectedSlot());
+    }
+    if (path.isEmpty() || (session_ && session_->isLoadedFor(path))) {
+        prefetcher_->cancel();
+        return;
+    }
+    prefetcher_->prefetch(path);
+}
+
 void MainWindow::loadSavePath(const QString &path)
 {
     if (path.isEmpty()) {
@@ -559,21 +723,7 @@ void MainWindow::loadSavePath(const QString &path)
 
 void MainWindow::maybeBackupOnLoad(const QString &path)
 {
-    QFileInfo info(path);
-    if (!info.exists()) {
-        return;
-    }
-    qint64 mtime = info.lastModified().toMSecsSinceEpoch();
-    if (lastBackupMtime_.value(path) == mtime) {
-        return;
-    }
-    const SaveSlot *slot = findSlotForPath(path);
-    QString error;
-    if (backupManager_.createBackup(path, slot, QStringLiteral("load"), nullptr, &error)) {
-        lastBackupMtime_.insert(path, mtime);
-    } else if (!error.isEmpty()) {
-        qWarning() << "Backup failed:" << error;
-    }
+    backupQueue_->requestBackup(backupManager_, path, saveSlots_, QStringLiteral("load"));
 }
 
 void MainWindow::refreshBackupsPage()
@@ -583,78 +733,72 @@ void MainWindow::refreshBackupsPage()
     }
     backupsPage_->setBackupRoot(backupManager_.rootPath());
     QString error;
-    QList<BackupEntry> entries = backupManager_.listBackups(&error);
-    if (backupsPage_->currentOnlyEnabled() && !currentSaveFile_.isEmpty()) {
-        QString target = QFileInfo(currentSaveFile_).canonicalFilePath();
-        if (target.isEmpty()) {
-            target = QFileInfo(currentSaveFile_).absoluteFilePath();
-        }
-        QList<BackupEntry> filtered;
-        filtered.reserve(entries.size());
-        for (const BackupEntry &entry : entries) {
-            QString source = QFileInfo(entry.sourcePath).canonicalFilePath();
-            if (source.isEmpty()) {
-                source = QFileInfo(entry.sourcePath).absoluteFilePath();
-            }
-            if (!source.isEmpty() && source == target) {
-                filtered.append(entry);
-            }
-        }
-        entries = filtered;
-    }
+    QList<BackupEntry> entries = backupsPage_->currentOnlyEnabled() && !currentSaveFile_.isEmpty()
+                                     ? backupManager_.listBackupsFor(currentSaveFile_, &error)
+                                     : backupManager_.listBackups(&error);
     backupsPage_->setBackups(entries);
     if (!error.isEmpty()) {
         qWarning() << "Backup listing error:" << error;
     }
 }
 
-const SaveSlot *MainWindow::findSlotForPath(const QString &path) const
+void MainWindow::showSaveDiff(const QString &backupPath, const QString &livePath)
 {
-    QString target = QFileInfo(path).canonicalFilePath();
-    if (target.isEmpty()) {
-        target = QFileInfo(path).absoluteFilePath();
-    }
-    for (const SaveSlot &slot : saveSlots_) {
-        for (const SaveSlot::SaveFileEntry &entry : slot.saveFiles) {
-            QString candidate = QFileInfo(entry.filePath).canonicalFilePath();
-            if (candidate.isEmpty()) {
-                candidate = QFileInfo(entry.filePath).absoluteFilePath();
-            }
-            if (!candidate.isEmpty() && candidate == target) {
-                return &slot;
-            }
-        }
+    // Compare against the open session so unsaved edits show up too.
+    std::shared_ptr<LosslessJsonDocument> liveDoc;
+    if (session_->isLoadedFor(livePath)) {
+        liveDoc = session_->lossless();
     }
-    return nullptr;
+    SaveDiffDialog dialog(backupPath, livePath, liveDoc, this);
+    dialog.exec();
+}
+
+const SaveSlot *MainWindow::findSlotForPath(const QString &path) const
+{
+    return SaveGameLocator::findSlotForFile(saveSlots_, path);
 }
 
 void MainWindow::loadSaveInBackground(
-    const QString &path, const QString &statusText,
+    const QString &path, const QString &statusText, QWidget *targetPage,
     const std::function<void(const LoadResult &)> &onLoaded)
 {
     if (path.isEmpty() || loadingWatcher_.isRunning()) {
         return;
     }
 
+    if (session_->isLoadedFor(path)) {
+        LoadResult result;
+        result.doc = session_->rootDoc();
+        result.lossless = session_->lossless();
+        onLoaded(result);
+        stalePages_.remove(targetPage);
+        return;
+    }
+
     loadingOverlay_->showMessage(statusText);
-    auto loadTask = [path]() {
+    // Let a prefetch already decoding this file finish and fill the cache
+    // rather than decoding it a second time alongside.
+    QFuture<void> prefetch = prefetcher_->pendingFor(path);
+    auto loadTask = [path, prefetch]() mutable {
+        prefetch.waitForFinished();
         LoadResult result;
-        QByteArray content;
-        if (!SaveCache::loadWithLossless(path, &content, &result.doc, &result.lossless, &result.error)) {
+        if (!SaveCache::loadWithLossless(path, &result.doc, &result.lossless, &result.error)) {
             return result;
         }
         return result;
     };
 
     connect(&loadingWatcher_, &QFutureWatcher<LoadResult>::finished, this,
-            [this, onLoaded]() {
+            [this, path, targetPage, onLoaded]() {
                 loadingOverlay_->hide();
                 LoadResult result = loadingWatcher_.result();
                 if (!result.error.isEmpty() || result.doc.isNull() || !result.lossless) {
                     setStatus(result.error.isEmpty() ? tr("Failed to load save data.") : result.error);
                     return;
                 }
+                session_->reset(path, result.doc, result.lossless);
                 onLoaded(result);
+                stalePages_.remove(targetPage);
             },
             Qt::SingleShotConnection);
 
@@ -666,16 +810,18 @@ void MainWindow::openJsonEditor()
     if (!ensureSaveLoaded()) {
         return;
     }
-    if (jsonPage_->hasLoadedSave() && jsonPage_->currentFilePath() == currentSaveFile_) {
+    if (jsonPage_->hasLoadedSave() && jsonPage_->currentFilePath() == currentSaveFile_
+        && !stalePages_.contains(jsonPage_)) {
         selectPage(kPageJson);
         return;
     }
 
     const QString path = currentSaveFile_;
-    loadSaveInBackground(path, tr("Decoding save file, please wait..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Decoding save file, please wait..."), jsonPage_,
+                         [this, path](const LoadResult &result) {
         jsonPage_->setRootDoc(result.doc, path, result.lossless);
         currentSaveFile_ = path;
-        welcomePage_->setSaveEnabled(jsonPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         updateSaveWatcher(currentSaveFile_);
         selectPage(kPageJson);
@@ -690,11 +836,13 @@ void MainWindow::openInventoryEditor()
     if (!ensureSaveLoaded()) {
         return;
     }
-    if (inventoryPage_->hasLoadedSave() && inventoryPage_->currentFilePath() == currentSaveFile_) {
+    if (inventoryPage_->hasLoadedSave() && inventoryPage_->currentFilePath() == currentSaveFile_
+        && !stalePages_.contains(inventoryPage_)) {
         selectPage(kPageInventory);
         return;
     }
-    if (inventoryPage_->hasLoadedSave() && inventoryPage_->hasUnsavedChanges()) {
+    if (inventoryPage_->hasLoadedSave() && inventoryPage_->hasUnsavedChanges()
+        && !session_->isLoadedFor(inventoryPage_->currentFilePath())) {
         if (!confirmDiscardOrSave(tr("Inventories"), [this](QString *error) {
                 return inventoryPage_->saveChanges(error);
             })) {
@@ -703,7 +851,8 @@ void MainWindow::openInventoryEditor()
     }
     QString path = currentSaveFile_;
 
-    loadSaveInBackground(path, tr("Loading inventories..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Loading inventories..."), inventoryPage_,
+                         [this, path](const LoadResult &result) {
         QString error;
         if (!inventoryPage_->loadFromPrepared(path, result.doc, result.lossless, &error)) {
             setStatus(error.isEmpty() ? tr("Failed to load Inventories.") : error);
@@ -711,7 +860,7 @@ void MainWindow::openInventoryEditor()
         }
         currentSaveFile_ = path;
         updateSaveWatcher(currentSaveFile_);
-        welcomePage_->setSaveEnabled(inventoryPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         selectPage(kPageInventory);
     });
@@ -725,11 +874,13 @@ void MainWindow::openCurrenciesEditor()
     if (!ensureSaveLoaded()) {
         return;
     }
-    if (currenciesPage_->hasLoadedSave() && currenciesPage_->currentFilePath() == currentSaveFile_) {
+    if (currenciesPage_->hasLoadedSave() && currenciesPage_->currentFilePath() == currentSaveFile_
+        && !stalePages_.contains(currenciesPage_)) {
         selectPage(kPageCurrencies);
         return;
     }
-    if (currenciesPage_->hasLoadedSave() && currenciesPage_->hasUnsavedChanges()) {
+    if (currenciesPage_->hasLoadedSave() && currenciesPage_->hasUnsavedChanges()
+        && !session_->isLoadedFor(currenciesPage_->currentFilePath())) {
         if (!confirmDiscardOrSave(tr("Currencies"), [this](QString *error) {
                 return currenciesPage_->saveChanges(error);
             })) {
@@ -738,7 +889,8 @@ void MainWindow::openCurrenciesEditor()
     }
     QString path = currentSaveFile_;
 
-    loadSaveInBackground(path, tr("Loading currencies..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Loading currencies..."), currenciesPage_,
+                         [this, path](const LoadResult &result) {
         QString error;
         if (!currenciesPage_->loadFromPrepared(path, result.doc, result.lossless, &error)) {
             setStatus(error.isEmpty() ? tr("Failed to load Currencies.") : error);
@@ -746,7 +898,7 @@ void MainWindow::openCurrenciesEditor()
         }
         currentSaveFile_ = path;
         updateSaveWatcher(currentSaveFile_);
-        welcomePage_->setSaveEnabled(currenciesPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         selectPage(kPageCurrencies);
     });
@@ -760,11 +912,13 @@ void MainWindow::openExpeditionEditor()
     if (!ensureSaveLoaded()) {
         return;
     }
-    if (expeditionPage_->hasLoadedSave() && expeditionPage_->currentFilePath() == currentSaveFile_) {
+    if (expeditionPage_->hasLoadedSave() && expeditionPage_->currentFilePath() == currentSaveFile_
+        && !stalePages_.contains(expeditionPage_)) {
         selectPage(kPageExpedition);
         return;
     }
-    if (expeditionPage_->hasLoadedSave() && expeditionPage_->hasUnsavedChanges()) {
+    if (expeditionPage_->hasLoadedSave() && expeditionPage_->hasUnsavedChanges()
+        && !session_->isLoadedFor(expeditionPage_->currentFilePath())) {
         if (!confirmDiscardOrSave(tr("Expedition"), [this](QString *error) {
                 return expeditionPage_->saveChanges(error);
             })) {
@@ -773,7 +927,8 @@ void MainWindow::openExpeditionEditor()
     }
     QString path = currentSaveFile_;
 
-    loadSaveInBackground(path, tr("Loading expedition data..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Loading expedition data..."), expeditionPage_,
+                         [this, path](const LoadResult &result) {
         QString error;
         if (!expeditionPage_->loadFromPrepared(path, result.doc, result.lossless, &error)) {
             setStatus(error.isEmpty() ? tr("Failed to load Expedition.") : error);
@@ -781,7 +936,7 @@ void MainWindow::openExpeditionEditor()
         }
         currentSaveFile_ = path;
         updateSaveWatcher(currentSaveFile_);
-        welcomePage_->setSaveEnabled(expeditionPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         selectPage(kPageExpedition);
     });
@@ -796,11 +951,13 @@ void MainWindow::openStorageManager()
         return;
     }
     if (storageManagerPage_->hasLoadedSave()
-        && storageManagerPage_->currentFilePath() == currentSaveFile_) {
+        && storageManagerPage_->currentFilePath() == currentSaveFile_
+        && !stalePages_.contains(storageManagerPage_)) {
         selectPage(kPageStorage);
         return;
     }
-    if (storageManagerPage_->hasLoadedSave() && storageManagerPage_->hasUnsavedChanges()) {
+    if (storageManagerPage_->hasLoadedSave() && storageManagerPage_->hasUnsavedChanges()
+        && !session_->isLoadedFor(storageManagerPage_->currentFilePath())) {
         if (!confirmDiscardOrSave(tr("Storage Manager"), [this](QString *error) {
                 return storageManagerPage_->saveChanges(error);
             })) {
@@ -809,7 +966,8 @@ void MainWindow::openStorageManager()
     }
     QString path = currentSaveFile_;
 
-    loadSaveInBackground(path, tr("Loading storage manager..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Loading storage manager..."), storageManagerPage_,
+                         [this, path](const LoadResult &result) {
         QString error;
         if (!storageManagerPage_->loadFromPrepared(path, result.doc, result.lossless, &error)) {
             setStatus(error.isEmpty() ? tr("Failed to load Storage Manager.") : error);
@@ -817,7 +975,7 @@ void MainWindow::openStorageManager()
         }
         currentSaveFile_ = path;
         updateSaveWatcher(currentSaveFile_);
-        welcomePage_->setSaveEnabled(storageManagerPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         selectPage(kPageStorage);
     });
@@ -833,11 +991,13 @@ void MainWindow::openSettlementManager()
     }
     QString path = currentSaveFile_;
     if (settlementPage_->hasLoadedSave()
-        && settlementPage_->currentFilePath() == currentSaveFile_) {
+        && settlementPage_->currentFilePath() == currentSaveFile_
+        && !stalePages_.contains(settlementPage_)) {
         selectPage(kPageSettlement);
         return;
     }
-    if (settlementPage_->hasLoadedSave() && settlementPage_->hasUnsavedChanges()) {
+    if (settlementPage_->hasLoadedSave() && settlementPage_->hasUnsavedChanges()
+        && !session_->isLoadedFor(settlementPage_->currentFilePath())) {
         if (!confirmDiscardOrSave(tr("Settlement Manager"), [this](QString *error) {
                 return settlementPage_->saveChanges(error);
             })) {
@@ -853,7 +1013,8 @@ void MainWindow::openSettlementManager()
         return;
     }
 
-    loadSaveInBackground(path, tr("Loading settlement manager..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Loading settlement manager..."), settlementPage_,
+                         [this, path](const LoadResult &result) {
         QString error;
         if (!settlementPage_->loadFromPrepared(path, result.doc, result.lossless, &error)) {
             setStatus(error.isEmpty() ? tr("Failed to load Settlement Manager.") : error);
@@ -862,7 +1023,7 @@ void MainWindow::openSettlementManager()
         currentSaveFile_ = path;
         maybeBackupOnLoad(currentSaveFile_);
         updateSaveWatcher(currentSaveFile_);
-        welcomePage_->setSaveEnabled(settlementPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         selectPage(kPageSettlement);
     });
@@ -879,11 +1040,13 @@ void MainWindow::openShipManager()
     QString path = currentSaveFile_;
 
     if (shipManagerPage_->hasLoadedSave()
-        && shipManagerPage_->currentFilePath() == currentSaveFile_) {
+        && shipManagerPage_->currentFilePath() == currentSaveFile_
+        && !stalePages_.contains(shipManagerPage_)) {
         selectPage(kPageShip);
         return;
     }
-    if (shipManagerPage_->hasLoadedSave() && shipManagerPage_->hasUnsavedChanges()) {
+    if (shipManagerPage_->hasLoadedSave() && shipManagerPage_->hasUnsavedChanges()
+        && !session_->isLoadedFor(shipManagerPage_->currentFilePath())) {
         if (!confirmDiscardOrSave(tr("Ship Manager"), [this](QString *error) {
                 return shipManagerPage_->saveChanges(error);
             })) {
@@ -891,7 +1054,8 @@ void MainWindow::openShipManager()
         }
     }
 
-    loadSaveInBackground(path, tr("Loading ship manager..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Loading ship manager..."), shipManagerPage_,
+                         [this, path](const LoadResult &result) {
         QString error;
         if (!shipManagerPage_->loadFromPrepared(path, result.doc, result.lossless, &error)) {
             setStatus(error.isEmpty() ? tr("Failed to load Ship Manager.") : error);
@@ -899,7 +1063,7 @@ void MainWindow::openShipManager()
         }
         currentSaveFile_ = path;
         updateSaveWatcher(currentSaveFile_);
-        welcomePage_->setSaveEnabled(shipManagerPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         selectPage(kPageShip);
     });
@@ -916,11 +1080,13 @@ void MainWindow::openFrigateTemplateManager()
     QString path = currentSaveFile_;
 
     if (frigateManagerPage_->hasLoadedSave()
-        && frigateManagerPage_->currentFilePath() == currentSaveFile_) {
+        && frigateManagerPage_->currentFilePath() == currentSaveFile_
+        && !stalePages_.contains(frigateManagerPage_)) {
         selectPage(kPageFrigateTemplate);
         return;
     }
-    if (frigateManagerPage_->hasLoadedSave() && frigateManagerPage_->hasUnsavedChanges()) {
+    if (frigateManagerPage_->hasLoadedSave() && frigateManagerPage_->hasUnsavedChanges()
+        && !session_->isLoadedFor(frigateManagerPage_->currentFilePath())) {
         if (!confirmDiscardOrSave(tr("Frigates"), [this](QString *error) {
                 return frigateManagerPage_->saveChanges(error);
             })) {
@@ -928,7 +1094,8 @@ void MainWindow::openFrigateTemplateManager()
         }
     }
 
-    loadSaveInBackground(path, tr("Loading frigates..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Loading frigates..."), frigateManagerPage_,
+                         [this, path](const LoadResult &result) {
         QString error;
         if (!frigateManagerPage_->loadFromPrepared(path, result.doc, result.lossless, &error)) {
             setStatus(error.isEmpty() ? tr("Failed to load Frigates.") : error);
@@ -936,7 +1103,7 @@ void MainWindow::openFrigateTemplateManager()
         }
         currentSaveFile_ = path;
         updateSaveWatcher(currentSaveFile_);
-        welcomePage_->setSaveEnabled(frigateManagerPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         selectPage(kPageFrigateTemplate);
     });
@@ -959,11 +1126,13 @@ void MainWindow::openKnownTechnologyEditor()
     QString path = currentSaveFile_;
 
     if (knownTechnologyPage_->hasLoadedSave()
-        && knownTechnologyPage_->currentFilePath() == path) {
+        && knownTechnologyPage_->currentFilePath() == path
+        && !stalePages_.contains(knownTechnologyPage_)) {
         selectPage(kPageKnownTechnology);
         return;
     }
-    if (knownTechnologyPage_->hasLoadedSave() && knownTechnologyPage_->hasUnsavedChanges()) {
+    if (knownTechnologyPage_->hasLoadedSave() && knownTechnologyPage_->hasUnsavedChanges()
+        && !session_->isLoadedFor(knownTechnologyPage_->currentFilePath())) {
         if (!confirmDiscardOrSave(tr("Known Technology"), [this](QString *error) {
                 return knownTechnologyPage_->saveChanges(error);
             })) {
@@ -971,7 +1140,8 @@ void MainWindow::openKnownTechnologyEditor()
         }
     }
 
-    loadSaveInBackground(path, tr("Loading known technology..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Loading known technology..."), knownTechnologyPage_,
+                         [this, path](const LoadResult &result) {
         QString error;
         if (!knownTechnologyPage_->loadFromPrepared(path, result.doc, result.lossless, &error)) {
             setStatus(error.isEmpty() ? tr("Failed to load Known Technology.") : error);
@@ -979,7 +1149,7 @@ void MainWindow::openKnownTechnologyEditor()
         }
         currentSaveFile_ = path;
         updateSaveWatcher(currentSaveFile_);
-        welcomePage_->setSaveEnabled(knownTechnologyPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         selectPage(kPageKnownTechnology);
     });
@@ -996,11 +1166,13 @@ void MainWindow::openKnownProductEditor()
     QString path = currentSaveFile_;
 
     if (knownProductPage_->hasLoadedSave()
-        && knownProductPage_->currentFilePath() == path) {
+        && knownProductPage_->currentFilePath() == path
+        && !stalePages_.contains(knownProductPage_)) {
         selectPage(kPageKnownProduct);
         return;
     }
-    if (knownProductPage_->hasLoadedSave() && knownProductPage_->hasUnsavedChanges()) {
+    if (knownProductPage_->hasLoadedSave() && knownProductPage_->hasUnsavedChanges()
+        && !session_->isLoadedFor(knownProductPage_->currentFilePath())) {
         if (!confirmDiscardOrSave(tr("Known Products"), [this](QString *error) {
                 return knownProductPage_->saveChanges(error);
             })) {
@@ -1008,7 +1180,8 @@ void MainWindow::openKnownProductEditor()
         }
     }
 
-    loadSaveInBackground(path, tr("Loading known products..."), [this, path](const LoadResult &result) {
+    loadSaveInBackground(path, tr("Loading known products..."), knownProductPage_,
+                         [this, path](const LoadResult &result) {
         QString error;
         if (!knownProductPage_->loadFromPrepared(path, result.doc, result.lossless, &error)) {
             setStatus(error.isEmpty() ? tr("Failed to load Known Products.") : error);
@@ -1016,7 +1189,7 @@ void MainWindow::openKnownProductEditor()
         }
         currentSaveFile_ = path;
         updateSaveWatcher(currentSaveFile_);
-        welcomePage_->setSaveEnabled(knownProductPage_->hasUnsavedChanges());
+        welcomePage_->setSaveEnabled(hasPendingChanges());
         welcomePage_->setLoadedSavePath(currentSaveFile_);
         selectPage(kPageKnownProduct);
     });
@@ -1051,58 +1224,62 @@ void MainWindow::saveChanges()
         return;
     }
 
-    QWidget *activePage = stackedPages_->currentWidget();
     QString error;
-    bool saved = false;
+    if (!saveThroughLoadedPage(&error)) {
+        setStatus(error.isEmpty() ? tr("No active editor to save.") : error);
+        return;
+    }
+    ignoreNextFileChange_ = true;
+    markSessionSaved();
+    updateHomeSaveEnabled();
+    setStatus(tr("Saved changes."));
+}
 
+// Pages write the shared document, so saving through the visible page, or the
+// first one with the save loaded, writes every pending edit.
+bool MainWindow::saveThroughLoadedPage(QString *error)
+{
+    QWidget *activePage = stackedPages_->currentWidget();
     if (activePage == jsonPage_ && jsonPage_->hasLoadedSave()) {
-        saved = jsonPage_->saveChanges(&error);
+        return jsonPage_->saveChanges(error);
     } else if (activePage == inventoryPage_ && inventoryPage_->hasLoadedSave()) {
-        saved = inventoryPage_->saveChanges(&error);
+        return inventoryPage_->saveChanges(error);
     } else if (activePage == settlementPage_ && settlementPage_->hasLoadedSave()) {
-        saved = settlementPage_->saveChanges(&error);
+        return settlementPage_->saveChanges(error);
     } else if (activePage == shipManagerPage_ && shipManagerPage_->hasLoadedSave()) {
-        saved = shipManagerPage_->saveChanges(&error);
+        return shipManagerPage_->saveChanges(error);
     } else if (activePage == frigateManagerPage_ && frigateManagerPage_->hasLoadedSave()) {
-        saved = frigateManagerPage_->saveChanges(&error);
+        return frigateManagerPage_->saveChanges(error);
     } else if (activePage == currenciesPage_ && currenciesPage_->hasLoadedSave()) {
-        saved = currenciesPage_->saveChanges(&error);
+        return currenciesPage_->saveChanges(error);
     } else if (activePage == expeditionPage_ && expeditionPage_->hasLoadedSave()) {
-        saved = expeditionPage_->saveChanges(&error);
+        return expeditionPage_->saveChanges(error);
     } else if (activePage == storageManagerPage_ && storageManagerPage_->hasLoadedSave()) {
-        saved = storageManagerPage_->saveChanges(&error);
+        return storageManagerPage_->saveChanges(error);
     } else if (activePage == knownTechnologyPage_ && knownTechnologyPage_->hasLoadedSave()) {
-        saved = knownTechnologyPage_->saveChanges(&error);
+        return knownTechnologyPage_->saveChanges(error);
     } else if (activePage == knownProductPage_ && knownProductPage_->hasLoadedSave()) {
-        saved = knownProductPage_->saveChanges(&error);
+        return knownProductPage_->saveChanges(error);
     } else if (jsonPage_->hasLoadedSave()) {
-        saved = jsonPage_->saveChanges(&error);
+        return jsonPage_->saveChanges(error);
     } else if (inventoryPage_->hasLoadedSave()) {
-        saved = inventoryPage_->saveChanges(&error);
+        return inventoryPage_->saveChanges(error);
     } else if (currenciesPage_->hasLoadedSave()) {
-        saved = currenciesPage_->saveChanges(&error);
+        return currenciesPage_->saveChanges(error);
     } else if (expeditionPage_->hasLoadedSave()) {
-        saved = expeditionPage_->saveChanges(&error);
+        return expeditionPage_->saveChanges(error);
     } else if (storageManagerPage_->hasLoadedSave()) {
-        saved = storageManagerPage_->saveChanges(&error);
+        return storageManagerPage_->saveChanges(error);
     } else if (knownTechnologyPage_->hasLoadedSave()) {
-        saved = knownTechnologyPage_->saveChanges(&error);
+        return knownTechnologyPage_->saveChanges(error);
     } else if (knownProductPage_->hasLoadedSave()) {
-        saved = knownProductPage_->saveChanges(&error);
+        return knownProductPage_->saveChanges(error);
     } else if (settlementPage_->hasLoadedSave()) {
-        saved = settlementPage_->saveChanges(&error);
+        return settlementPage_->saveChanges(error);
     } else if (shipManagerPage_->hasLoadedSave()) {
-        saved = shipManagerPage_->saveChanges(&error);
-    }
-
-    if (!saved) {
-        setStatus(error.isEmpty() ? tr("No active editor to save.") : error);
-        return;
+        return shipManagerPage_->saveChanges(error);
     }
-    ignoreNextFileChange_ = true;
-    SaveCache::clear();
-    updateHomeSaveEnabled();
-    setStatus(tr("Saved changes."));
+    return false;
 }
 
 void MainWindow::syncOtherSave()
@@ -1132,10 +1309,24 @@ void MainWindow::syncOtherSave()
     QPushButton *syncButton = new QPushButton(tr("Sync"), &dialog);
     syncButton->setEnabled(false);
     buttonBox->addButton(syncButton, QDialogButtonBox::AcceptRole);
+    QPushButton *compareButton = new QPushButton(tr("Compare"), &dialog);
+    compareButton->setEnabled(false);
+    buttonBox->addButton(compareButton, QDialogButtonBox::ActionRole);
     layout->addWidget(buttonBox);
 
-    connect(list, &QListWidget::currentRowChanged, &dialog, [syncButton](int row) {
+    connect(list, &QListWidget::currentRowChanged, &dialog, [syncButton, compareButton](int row) {
         syncButton->setEnabled(row >= 0);
+        compareButton->setEnabled(row >= 0);
+    });
+    connect(compareButton, &QPushButton::clicked, &dialog, [this, &dialog, list, entries]() {
+        // Shows what the first other file would become after syncing.
+        int row = list->currentRow();
+        if (row < 0 || row >= entries.size()) {
+            return;
+        }
+        int targetRow = row == 0 ? 1 : 0;
+        SaveDiffDialog diffDialog(entries.at(targetRow).filePath, entries.at(row).filePath, nullptr, &dialog);
+        diffDialog.exec();
     });
     connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
     connect(syncButton, &QPushButton::clicked, &dialog, &QDialog::accept);
@@ -1251,6 +1442,60 @@ void MainWindow::undoSync()
     setStatus(tr("Sync undone."));
 }
 
+void MainWindow::undoEdit()
+{
+    if (!session_->undo()) {
+        return;
+    }
+    reopenCurrentPage();
+    updateHomeSaveEnabled();
+    setStatus(tr("Undid last edit."));
+}
+
+void MainWindow::redoEdit()
+{
+    if (!session_->redo()) {
+        return;
+    }
+    reopenCurrentPage();
+    updateHomeSaveEnabled();
+    setStatus(tr("Redid edit."));
+}
+
+void MainWindow::updateHistoryActions()
+{
+    undoAction_->setEnabled(session_->canUndo());
+    redoAction_->setEnabled(session_->canRedo());
+}
+
+// Undo and redo leave every page stale; the visible one is reloaded from the
+// session right away, the rest when they are next opened.
+void MainWindow::reopenCurrentPage()
+{
+    QWidget *page = stackedPages_->currentWidget();
+    if (page == jsonPage_) {
+        openJsonEditor();
+    } else if (page == inventoryPage_) {
+        openInventoryEditor();
+    } else if (page == currenciesPage_) {
+        openCurrenciesEditor();
+    } else if (page == expeditionPage_) {
+        openExpeditionEditor();
+    } else if (page == storageManagerPage_) {
+        openStorageManager();
+    } else if (page == settlementPage_) {
+        openSettlementManager();
+    } else if (page == shipManagerPage_) {
+        openShipManager();
+    } else if (page == frigateManagerPage_) {
+        openFrigateTemplateManager();
+    } else if (page == knownTechnologyPage_) {
+        openKnownTechnologyEditor();
+    } else if (page == knownProductPage_) {
+        openKnownProductEditor();
+    }
+}
+
 void MainWindow::setStatus(const QString &text)
 {
     qInfo() << "Status bar:" << text;
@@ -1279,7 +1524,7 @@ void MainWindow::unloadCurrentSave()
         return;
     }
 
-    SaveCache::clear();
+    session_->clear();
     currentSaveFile_.clear();
     updateSaveWatcher(QString());
     if (jsonPage_) {
@@ -1361,18 +1606,101 @@ void MainWindow::selectPage(const QString &key)
     }
 }
 
-bool MainWindow::hasPendingChanges() const
+QList<QWidget *> MainWindow::editorPages() const
+{
+    return {jsonPage_, inventoryPage_, currenciesPage_, expeditionPage_, storageManagerPage_,
+            settlementPage_, shipManagerPage_, frigateManagerPage_, knownTechnologyPage_,
+            knownProductPage_};
+}
+
+void MainWindow::markSessionSaved()
+{
+    session_->markSaved();
+    if (session_->isLoadedFor(currentSaveFile_)) {
+        prefetcher_->installSaved(currentSaveFile_, session_->rootDoc(), session_->lossless());
+    }
+    // Every page writes the shared document, so one save covers the edits made
+    // on the other pages too; drop their pending flags by reloading them from
+    // the session the next time they are opened.
+    QWidget *activePage = stackedPages_->currentWidget();
+    dropPendingFlag(jsonPage_, activePage);
+    dropPendingFlag(inventoryPage_, activePage);
+    dropPendingFlag(currenciesPage_, activePage);
+    dropPendingFlag(expeditionPage_, activePage);
+    dropPendingFlag(storageManagerPage_, activePage);
+    dropPendingFlag(settlementPage_, activePage);
+    dropPendingFlag(shipManagerPage_, activePage);
+    dropPendingFlag(frigateManagerPage_, activePage);
+    dropPendingFlag(knownTechnologyPage_, activePage);
+    dropPendingFlag(knownProductPage_, activePage);
+}
+
+QList<MainWindow::PendingChange> MainWindow::pendingChanges()
+{
+    QList<PendingChange> pending;
+    if (jsonPage_ && jsonPage_->hasLoadedSave() && jsonPage_->hasUnsavedChanges()) {
+        pending.append({tr("JSON Explorer"), [this](QString *error) {
+            return jsonPage_->saveChanges(error);
+        }});
+    }
+    if (inventoryPage_ && inventoryPage_->hasLoadedSave() && inventoryPage_->hasUnsavedChanges()) {
+        pending.append({tr("Inventories"), [this](QString *error) {
+            return inventoryPage_->saveChanges(error);
+        }});
+    }
+    if (currenciesPage_ && currenciesPage_->hasLoadedSave() && currenciesPage_->hasUnsavedChanges()) {
+        pending.append({tr("Currencies"), [this](QString *error) {
+            return currenciesPage_->saveChanges(error);
+        }});
+    }
+    if (expeditionPage_ && expeditionPage_->hasLoadedSave() && expeditionPage_->hasUnsavedChanges()) {
+        pending.append({tr("Expedition"), [this](QString *error) {
+            return expeditionPage_->saveChanges(error);
+        }});
+    }
+    if (storageManagerPage_ && storageManagerPage_->hasLoadedSave() && storageManagerPage_->hasUnsavedChanges()) {
+        pending.append({tr("Storage Manager"), [this](QString *error) {
+            return storageManagerPage_->saveChanges(error);
+        }});
+    }
+    if (knownTechnologyPage_ && knownTechnologyPage_->hasLoadedSave() && knownTechnologyPage_->hasUnsavedChanges()) {
+        pending.append({tr("Known Technology"), [this](QString *error) {
+            return knownTechnologyPage_->saveChanges(error);
+        }});
+    }
+    if (knownProductPage_ && knownProductPage_->hasLoadedSave() && knownProductPage_->hasUnsavedChanges()) {
+        pending.append({tr("Known Products"), [this](QString *error) {
+            return knownProductPage_->saveChanges(error);
+        }});
+    }
+    if (settlementPage_ && settlementPage_->hasLoadedSave() && settlementPage_->hasUnsavedChanges()) {
+        pending.append({tr("Settlement Manager"), [this](QString *error) {
+            return settlementPage_->saveChanges(error);
+        }});
+    }
+    if (shipManagerPage_ && shipManagerPage_->hasLoadedSave() && shipManagerPage_->hasUnsavedChanges()) {
+        pending.append({tr("Ship Manager"), [this](QString *error) {
+            return shipManagerPage_->saveChanges(error);
+        }});
+    }
+    if (frigateManagerPage_ && frigateManagerPage_->hasLoadedSave() && frigateManagerPage_->hasUnsavedChanges()) {
+        pending.append({tr("Frigates"), [this](QString *error) {
+            return frigateManagerPage_->saveChanges(error);
+        }});
+    }
+    // Undo and redo reload the open page, which clears its own flag while the
+    // session still holds the edits that are left.
+    if (pending.isEmpty() && session_ && session_->isDirty()) {
+        pending.append({tr("Current save"), [this](QString *error) {
+            return saveThroughLoadedPage(error);
+        }});
+    }
+    return pending;
+}
+
+bool MainWindow::hasPendingChanges()
 {
-    return (jsonPage_ && jsonPage_->hasLoadedSave() && jsonPage_->hasUnsavedChanges())
-        || (inventoryPage_ && inventoryPage_->hasLoadedSave() && inventoryPage_->hasUnsavedChanges())
-        || (currenciesPage_ && currenciesPage_->hasLoadedSave() && currenciesPage_->hasUnsavedChanges())
-        || (expeditionPage_ && expeditionPage_->hasLoadedSave() && expeditionPage_->hasUnsavedChanges())
-        || (storageManagerPage_ && storageManagerPage_->hasLoadedSave() && storageManagerPage_->hasUnsavedChanges())
-        || (knownTechnologyPage_ && knownTechnologyPage_->hasLoadedSave() && knownTechnologyPage_->hasUnsavedChanges())
-        || (knownProductPage_ && knownProductPage_->hasLoadedSave() && knownProductPage_->hasUnsavedChanges())
-        || (settlementPage_ && settlementPage_->hasLoadedSave() && settlementPage_->hasUnsavedChanges())
-        || (shipManagerPage_ && shipManagerPage_->hasLoadedSave() && shipManagerPage_->hasUnsavedChanges())
-        || (frigateManagerPage_ && frigateManagerPage_->hasLoadedSave() && frigateManagerPage_->hasUnsavedChanges());
+    return !pendingChanges().isEmpty();
 }
 
 void MainWindow::updateHomeSaveEnabled()
@@ -1408,7 +1736,7 @@ bool MainWindow::confirmLeaveJsonEditor(const QString &nextAction)
             return false;
         }
         ignoreNextFileChange_ = true;
-        SaveCache::clear();
+        markSessionSaved();
         updateHomeSaveEnabled();
         setStatus(tr("Saved changes."));
         return true;
@@ -1441,65 +1769,18 @@ bool MainWindow::confirmDiscardOrSave(const QString &pageName,
 
 void MainWindow::closeEvent(QCloseEvent *event)
 {
-    struct PendingChange {
-        QString name;
-        std::function<bool(QString *)> saveFn;
+    // Backups and restores still queued must land before the process exits.
+    auto accept = [this, event]() {
+        if (!backupQueue_->isIdle()) {
+            setStatus(tr("Finishing backups..."));
+        }
+        backupQueue_->drain();
+        event->accept();
     };
 
-    QList<PendingChange> pending;
-    if (jsonPage_->hasLoadedSave() && jsonPage_->hasUnsavedChanges()) {
-        pending.append({tr("JSON Explorer"), [this](QString *error) {
-            return jsonPage_->saveChanges(error);
-        }});
-    }
-    if (inventoryPage_->hasLoadedSave() && inventoryPage_->hasUnsavedChanges()) {
-        pending.append({tr("Inventories"), [this](QString *error) {
-            return inventoryPage_->saveChanges(error);
-        }});
-    }
-    if (currenciesPage_->hasLoadedSave() && currenciesPage_->hasUnsavedChanges()) {
-        pending.append({tr("Currencies"), [this](QString *error) {
-            return currenciesPage_->saveChanges(error);
-        }});
-    }
-    if (expeditionPage_->hasLoadedSave() && expeditionPage_->hasUnsavedChanges()) {
-        pending.append({tr("Expedition"), [this](QString *error) {
-            return expeditionPage_->saveChanges(error);
-        }});
-    }
-    if (storageManagerPage_->hasLoadedSave() && storageManagerPage_->hasUnsavedChanges()) {
-        pending.append({tr("Storage Manager"), [this](QString *error) {
-            return storageManagerPage_->saveChanges(error);
-        }});
-    }
-    if (knownTechnologyPage_->hasLoadedSave() && knownTechnologyPage_->hasUnsavedChanges()) {
-        pending.append({tr("Known Technology"), [this](QString *error) {
-            return knownTechnologyPage_->saveChanges(error);
-        }});
-    }
-    if (knownProductPage_->hasLoadedSave() && knownProductPage_->hasUnsavedChanges()) {
-        pending.append({tr("Known Products"), [this](QString *error) {
-            return knownProductPage_->saveChanges(error);
-        }});
-    }
-    if (settlementPage_->hasLoadedSave() && settlementPage_->hasUnsavedChanges()) {
-        pending.append({tr("Settlement Manager"), [this](QString *error) {
-            return settlementPage_->saveChanges(error);
-        }});
-    }
-    if (shipManagerPage_->hasLoadedSave() && shipManagerPage_->hasUnsavedChanges()) {
-        pending.append({tr("Ship Manager"), [this](QString *error) {
-            return shipManagerPage_->saveChanges(error);
-        }});
-    }
-    if (frigateManagerPage_->hasLoadedSave() && frigateManagerPage_->hasUnsavedChanges()) {
-        pending.append({tr("Frigates"), [this](QString *error) {
-            return frigateManagerPage_->saveChanges(error);
-        }});
-    }
-
+    const QList<PendingChange> pending = pendingChanges();
     if (pending.isEmpty()) {
-        event->accept();
+        accept();
         return;
     }
 
@@ -1522,7 +1803,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
         return;
     }
     if (response == QMessageBox::Discard) {
-        event->accept();
+        accept();
         return;
     }
 
@@ -1534,7 +1815,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
             return;
         }
     }
-    event->accept();
+    accept();
 }
 
 void MainWindow::updateSaveWatcher(const QString &path)
@@ -1570,12 +1851,16 @@ void MainWindow::handleSaveFileChanged(const QString &path)
         QMessageBox::Yes | QMessageBox::No,
         QMessageBox::Yes);
     if (response == QMessageBox::Yes) {
-        QString error;
-        if (!jsonPage_->loadFromFile(currentSaveFile_, &error)) {
-            setStatus(error);
-        } else {
-            setStatus(tr("Reloaded %1").arg(QFileInfo(currentSaveFile_).fileName()));
-        }
+        // Dropping the session marks every page stale, so each one picks up
+        // the reloaded document when it is next opened.
+        session_->clear();
+        const QString reloadPath = currentSaveFile_;
+        loadSaveInBackground(reloadPath, tr("Reloading save file..."), jsonPage_,
+                             [this, reloadPath](const LoadResult &result) {
+            jsonPage_->setRootDoc(result.doc, reloadPath, result.lossless);
+            updateHomeSaveEnabled();
+            setStatus(tr("Reloaded %1").arg(QFileInfo(reloadPath).fileName()));
+        });
     }
     updateSaveWatcher(path);
 }
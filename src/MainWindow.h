@@ -5,6 +5,9 @@
 #include <QJsonDocument>
 #include <QFutureWatcher>
 #include <QHash>
+#include <QList>
+#include <QSet>
+#include <QTemporaryDir>
 #include <functional>
 #include <memory>
 
@@ -28,6 +31,9 @@ class BackupsPage;
 class FrigateManagerPage;
 class KnownTechnologyPage;
 class KnownProductPage;
+class BackupQueue;
+class SavePrefetcher;
+class SaveSession;
 
 class MainWindow : public QMainWindow
 {
@@ -45,6 +51,10 @@ private:
         QString error;
         std::shared_ptr<LosslessJsonDocument> lossless;
     };
+    struct PendingChange {
+        QString name;
+        std::function<bool(QString *)> saveFn;
+    };
     void buildUi();
     void buildMenus();
     void refreshSaveSlots();
@@ -53,6 +63,7 @@ private:
     void browseForSave();
     void browseForSaveDirectory();
     void loadSelectedSave();
+    void prefetchSelectedSave();
     void loadSavePath(const QString &path);
     void openJsonEditor();
     void openInventoryEditor();
@@ -66,14 +77,22 @@ private:
     void openKnownTechnologyEditor();
     void openKnownProductEditor();
     void saveChanges();
+    bool saveThroughLoadedPage(QString *error);
     void syncOtherSave();
     void undoSync();
+    void undoEdit();
+    void redoEdit();
+    void updateHistoryActions();
+    void reopenCurrentPage();
     void setStatus(const QString &text);
-    void loadSaveInBackground(const QString &path, const QString &statusText,
+    void loadSaveInBackground(const QString &path, const QString &statusText, QWidget *targetPage,
                               const std::function<void(const LoadResult &)> &onLoaded);
+    QList<QWidget *> editorPages() const;
+    void markSessionSaved();
     void selectPage(const QString &key);
     bool ensureSaveLoaded();
-    bool hasPendingChanges() const;
+    QList<PendingChange> pendingChanges();
+    bool hasPendingChanges();
     void updateHomeSaveEnabled();
     QString resolveLatestSavePath(const SaveSlot &slot) const;
     bool confirmLeaveJsonEditor(const QString &nextAction);
@@ -83,6 +102,7 @@ private:
     void handleSaveFileChanged(const QString &path);
     void maybeBackupOnLoad(const QString &path);
     void refreshBackupsPage();
+    void showSaveDiff(const QString &backupPath, const QString &livePath);
     const SaveSlot *findSlotForPath(const QString &path) const;
 
     struct PendingSyncTarget {
@@ -114,7 +134,15 @@ private:
     LoadingOverlay *loadingOverlay_ = nullptr;
     BackupsPage *backupsPage_ = nullptr;
     QAction *saveAction_ = nullptr;
+    QAction *undoAction_ = nullptr;
+    QAction *redoAction_ = nullptr;
     QFutureWatcher<LoadResult> loadingWatcher_;
+    SaveSession *session_ = nullptr;
+    SavePrefetcher *prefetcher_ = nullptr;
+    BackupQueue *backupQueue_ = nullptr;
+    std::unique_ptr<QTemporaryDir> compareDir_;
+    int compareCount_ = 0;
+    QSet<QWidget *> stalePages_;
     bool ignoreNextFileChange_ = false;
     bool syncPending_ = false;
     bool syncUndoAvailable_ = false;
@@ -122,6 +150,5 @@ private:
 
     QList<SaveSlot> saveSlots_;
     QString currentSaveFile_;
-    QHash<QString, qint64> lastBackupMtime_;
     BackupManager backupManager_;
 };
@@ -0,0 +1,584 @@
+#include "core/BackupBlobStore.h"
+
+#include "core/BinaryDelta.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QVector>
+#include <QtConcurrent>
+#include <cstring>
+#include <limits>
+
+#include "lz4.h"
+
+namespace {
+constexpr quint32 kMagic = 0xFEEDA1E5;
+constexpr int kChunkHeaderSize = 16;
+constexpr char kBlobMagic[4] = {'N', 'M', 'S', 'B'};
+constexpr int kBlobHeaderSize = 8;
+constexpr char kBlobVersion = 1;
+constexpr char kKindRaw = 0;
+constexpr char kKindContainer = 1;
+constexpr char kKindDelta = 2;
+constexpr int kMinChecksumLength = 2;
+constexpr quint32 kMaxChecksumLength = 128;
+// A delta chain is cut with a keyframe this often, which bounds how many
+// blobs a restore has to read.
+constexpr int kKeyframeInterval = 16;
+constexpr int kMaxChainDepth = 64;
+
+quint32 readLe32(const char *data)
+{
+    const unsigned char *ptr = reinterpret_cast<const unsigned char *>(data);
+    return static_cast<quint32>(ptr[0])
+           | (static_cast<quint32>(ptr[1]) << 8)
+           | (static_cast<quint32>(ptr[2]) << 16)
+           | (static_cast<quint32>(ptr[3]) << 24);
+}
+
+void appendLe32(QByteArray *out, quint32 value)
+{
+    char bytes[4];
+    bytes[0] = static_cast<char>(value & 0xFF);
+    bytes[1] = static_cast<char>((value >> 8) & 0xFF);
+    bytes[2] = static_cast<char>((value >> 16) & 0xFF);
+    bytes[3] = static_cast<char>((value >> 24) & 0xFF);
+    out->append(bytes, 4);
+}
+
+struct ContainerChunk {
+    QByteArray header;
+    qint64 fileOffset = 0;
+    qint64 payloadOffset = 0;
+    int compressedSize = 0;
+    int uncompressedSize = 0;
+    int resultSize = 0;
+    QByteArray packed;
+};
+
+// A .hg split into the bytes LZ4 does not produce (anything before the first
+// chunk, each 16-byte chunk header, anything after the last chunk) and the
+// decoded payload the chunks carry.
+struct Container {
+    QByteArray header;
+    QVector<ContainerChunk> chunks;
+    QByteArray tail;
+    QByteArray payload;
+};
+
+template <typename Fn>
+void forEachChunk(QVector<ContainerChunk> &chunks, Fn fn)
+{
+    if (chunks.size() > 1) {
+        QtConcurrent::blockingMap(chunks, fn);
+    } else {
+        for (ContainerChunk &chunk : chunks) {
+            fn(chunk);
+        }
+    }
+}
+
+// Fills in sizes and payload offsets from the chunk headers. Returns the
+// payload size, or -1 when a header is malformed.
+qint64 indexChunks(QVector<ContainerChunk> &chunks)
+{
+    qint64 payloadSize = 0;
+    for (ContainerChunk &chunk : chunks) {
+        const quint32 compressedSize = readLe32(chunk.header.constData() + 4);
+        const quint32 uncompressedSize = readLe32(chunk.header.constData() + 8);
+        if ((compressedSize == 0) != (uncompressedSize == 0)
+            || compressedSize > static_cast<quint32>(std::numeric_limits<int>::max())
+            || uncompressedSize > static_cast<quint32>(std::numeric_limits<int>::max())) {
+            return -1;
+        }
+        chunk.compressedSize = static_cast<int>(compressedSize);
+        chunk.uncompressedSize = static_cast<int>(uncompressedSize);
+        chunk.payloadOffset = payloadSize;
+        payloadSize += uncompressedSize;
+        if (payloadSize > std::numeric_limits<int>::max()) {
+            return -1;
+        }
+    }
+    return payloadSize;
+}
+
+bool splitContainer(const QByteArray &data, Container *container)
+{
+    int start = -1;
+    for (int i = 0; i + 4 <= data.size(); ++i) {
+        if (readLe32(data.constData() + i) == kMagic) {
+            start = i;
+            break;
+        }
+    }
+    if (start < 0) {
+        return false;
+    }
+
+    container->header = data.left(start);
+    qint64 offset = start;
+    while (offset + kChunkHeaderSize <= data.size()) {
+        if (readLe32(data.constData() + offset) != kMagic) {
+            break;
+        }
+        ContainerChunk chunk;
+        chunk.header = data.mid(static_cast<int>(offset), kChunkHeaderSize);
+        chunk.fileOffset = offset + kChunkHeaderSize;
+        const quint32 compressedSize = readLe32(data.constData() + offset + 4);
+        container->chunks.append(chunk);
+        offset = chunk.fileOffset + compressedSize;
+        if (compressedSize == 0) {
+            break;
+        }
+    }
+    if (offset > data.size()) {
+        return false;
+    }
+    container->tail = data.mid(static_cast<int>(offset));
+
+    const qint64 payloadSize = indexChunks(container->chunks);
+    if (payloadSize < 0) {
+        return false;
+    }
+    container->payload.resize(static_cast<int>(payloadSize));
+    char *payloadData = container->payload.data();
+    forEachChunk(container->chunks, [&data, payloadData](ContainerChunk &chunk) {
+        if (chunk.uncompressedSize == 0) {
+            return;
+        }
+        chunk.resultSize = LZ4_decompress_safe(data.constData() + chunk.fileOffset,
+                                               payloadData + chunk.payloadOffset,
+                                               chunk.compressedSize, chunk.uncompressedSize);
+    });
+    for (const ContainerChunk &chunk : container->chunks) {
+        if (chunk.resultSize != chunk.uncompressedSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Recompresses every chunk from the payload. Fails when a chunk does not come
+// out at the size its header records, since the file could not match then.
+bool rebuildContainer(Container &container, QByteArray *out)
+{
+    const QByteArray &payload = container.payload;
+    forEachChunk(container.chunks, [&payload](ContainerChunk &chunk) {
+        if (chunk.uncompressedSize == 0) {
+            return;
+        }
+        chunk.packed.resize(LZ4_compressBound(chunk.uncompressedSize));
+        chunk.resultSize = LZ4_compress_default(payload.constData() + chunk.payloadOffset,
+                                                chunk.packed.data(), chunk.uncompressedSize,
+                                                chunk.packed.size());
+    });
+
+    qint64 totalSize = container.header.size() + container.tail.size();
+    for (const ContainerChunk &chunk : container.chunks) {
+        if (chunk.uncompressedSize != 0 && chunk.resultSize != chunk.compressedSize) {
+            return false;
+        }
+        totalSize += kChunkHeaderSize + chunk.compressedSize;
+    }
+
+    out->clear();
+    out->reserve(static_cast<int>(totalSize));
+    out->append(container.header);
+    for (ContainerChunk &chunk : container.chunks) {
+        out->append(chunk.header);
+        out->append(chunk.packed.constData(), chunk.compressedSize);
+        chunk.packed = QByteArray();
+    }
+    out->append(container.tail);
+    return true;
+}
+
+QByteArray blobHeader(char kind)
+{
+    QByteArray out(kBlobMagic, 4);
+    out.append(kBlobVersion);
+    out.append(kind);
+    out.append(2, '\0');
+    return out;
+}
+
+bool hasBlobHeader(const QByteArray &blob)
+{
+    return blob.size() >= kBlobHeaderSize && memcmp(blob.constData(), kBlobMagic, 4) == 0
+           && blob.at(4) == kBlobVersion;
+}
+
+bool readBlobFile(const QString &path, QByteArray *blob)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    *blob = file.readAll();
+    return hasBlobHeader(*blob);
+}
+
+void appendLayout(QByteArray *out, const Container &container)
+{
+    appendLe32(out, static_cast<quint32>(container.header.size()));
+    out->append(container.header);
+    appendLe32(out, static_cast<quint32>(container.chunks.size()));
+    for (const ContainerChunk &chunk : container.chunks) {
+        out->append(chunk.header);
+    }
+    appendLe32(out, static_cast<quint32>(container.tail.size()));
+    out->append(container.tail);
+}
+
+bool appendPacked(QByteArray *out, const QByteArray &data)
+{
+    QByteArray packed;
+    packed.resize(LZ4_compressBound(data.size()));
+    const int packedSize = LZ4_compress_default(data.constData(), packed.data(), data.size(),
+                                                packed.size());
+    if (packedSize <= 0) {
+        return false;
+    }
+    appendLe32(out, static_cast<quint32>(data.size()));
+    appendLe32(out, static_cast<quint32>(packedSize));
+    out->append(packed.constData(), packedSize);
+    return true;
+}
+
+QByteArray serializeContainer(const Container &container)
+{
+    QByteArray out = blobHeader(kKindContainer);
+    appendLayout(&out, container);
+    if (!appendPacked(&out, container.payload)) {
+        return QByteArray();
+    }
+    return out;
+}
+
+QByteArray encodeBlob(const QByteArray &hgBytes)
+{
+    Container container;
+    QByteArray rebuilt;
+    if (splitContainer(hgBytes, &container) && rebuildContainer(container, &rebuilt)
+        && rebuilt == hgBytes) {
+        QByteArray blob = serializeContainer(container);
+        if (!blob.isEmpty()) {
+            return blob;
+        }
+    }
+    QByteArray blob = blobHeader(kKindRaw);
+    blob.append(hgBytes);
+    return blob;
+}
+
+struct BlobReader {
+    const QByteArray &data;
+    qint64 offset = kBlobHeaderSize;
+
+    bool takeLe32(quint32 *value)
+    {
+        if (offset + 4 > data.size()) {
+            return false;
+        }
+        *value = readLe32(data.constData() + offset);
+        offset += 4;
+        return true;
+    }
+
+    bool takeBytes(qint64 size, QByteArray *out)
+    {
+        if (size < 0 || offset + size > data.size()) {
+            return false;
+        }
+        *out = data.mid(static_cast<int>(offset), static_cast<int>(size));
+        offset += size;
+        return true;
+    }
+
+    bool takePacked(QByteArray *out)
+    {
+        quint32 size = 0;
+        quint32 packedSize = 0;
+        QByteArray packed;
+        if (!takeLe32(&size) || !takeLe32(&packedSize) || !takeBytes(packedSize, &packed)
+            || size > static_cast<quint32>(std::numeric_limits<int>::max())) {
+            return false;
+        }
+        out->resize(static_cast<int>(size));
+        const int decoded = LZ4_decompress_safe(packed.constData(), out->data(), packed.size(),
+                                                out->size());
+        return decoded == out->size();
+    }
+
+    bool takeLayout(Container *container)
+    {
+        quint32 headerSize = 0;
+        quint32 chunkCount = 0;
+        quint32 tailSize = 0;
+        QByteArray chunkHeaders;
+        if (!takeLe32(&headerSize) || !takeBytes(headerSize, &container->header)
+            || !takeLe32(&chunkCount)
+            || !takeBytes(static_cast<qint64>(chunkCount) * kChunkHeaderSize, &chunkHeaders)
+            || !takeLe32(&tailSize) || !takeBytes(tailSize, &container->tail)) {
+            return false;
+        }
+        container->chunks.resize(static_cast<int>(chunkCount));
+        for (int i = 0; i < container->chunks.size(); ++i) {
+            container->chunks[i].header = chunkHeaders.mid(i * kChunkHeaderSize, kChunkHeaderSize);
+        }
+        return true;
+    }
+};
+
+// Reads a container or delta blob back into its layout and decoded payload,
+// following delta bases through the store. depth receives the blob's
+// distance from its keyframe.
+bool readContainer(const BackupBlobStore &store, const QByteArray &blob, Container *container,
+                   int *depth, int remainingDepth)
+{
+    BlobReader reader{blob};
+    const char kind = blob.at(5);
+    if (kind == kKindContainer) {
+        *depth = 0;
+        if (!reader.takeLayout(container) || !reader.takePacked(&container->payload)) {
+            return false;
+        }
+    } else if (kind == kKindDelta && remainingDepth > 0) {
+        quint32 storedDepth = 0;
+        quint32 baseLength = 0;
+        QByteArray baseChecksum;
+        QByteArray ops;
+        if (!reader.takeLe32(&storedDepth) || !reader.takeLe32(&baseLength)
+            || !reader.takeBytes(baseLength, &baseChecksum) || !reader.takeLayout(container)
+            || !reader.takePacked(&ops)) {
+            return false;
+        }
+        QByteArray baseBlob;
+        Container base;
+        int baseDepth = 0;
+        if (!readBlobFile(store.blobPath(QString::fromLatin1(baseChecksum)), &baseBlob)
+            || !readContainer(store, baseBlob, &base, &baseDepth, remainingDepth - 1)
+            || !BinaryDelta::apply(base.payload, ops, &container->payload)) {
+            return false;
+        }
+        *depth = static_cast<int>(storedDepth);
+    } else {
+        return false;
+    }
+    return indexChunks(container->chunks) == static_cast<qint64>(container->payload.size());
+}
+
+bool writeBlob(const QString &path, const QByteArray &blob, QString *errorMessage)
+{
+    QSaveFile outFile(path);
+    if (!outFile.open(QIODevice::WriteOnly)) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Unable to write backup file.");
+        }
+        return false;
+    }
+    if (outFile.write(blob) != blob.size()) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Failed to write backup file.");
+        }
+        return false;
+    }
+    if (!outFile.commit()) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Failed to finalize backup file.");
+        }
+        return false;
+    }
+    return true;
+}
+}
+
+BackupBlobStore::BackupBlobStore(const QString &backupRoot)
+    : blobRoot_(QDir(backupRoot).filePath(QStringLiteral("blobs")))
+{
+}
+
+QString BackupBlobStore::blobPath(const QString &checksum) const
+{
+    const QString key = checksum.toLower();
+    return QDir(blobRoot_).filePath(QStringLiteral("%1/%2").arg(key.left(2), key));
+}
+
+bool BackupBlobStore::contains(const QString &checksum) const
+{
+    return checksum.size() >= kMinChecksumLength && QFileInfo::exists(blobPath(checksum));
+}
+
+bool BackupBlobStore::store(const QByteArray &hgBytes, const QString &checksum, qint64 *storedBytes,
+                            QString *errorMessage) const
+{
+    if (storedBytes) {
+        *storedBytes = 0;
+    }
+    if (checksum.size() < kMinChecksumLength) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Invalid backup checksum.");
+        }
+        return false;
+    }
+    if (contains(checksum)) {
+        return true;
+    }
+
+    const QString path = blobPath(checksum);
+    QDir dir(QFileInfo(path).absolutePath());
+    if (!dir.exists() && !dir.mkpath(".")) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Unable to create backup folder.");
+        }
+        return false;
+    }
+
+    const QByteArray blob = encodeBlob(hgBytes);
+    if (!writeBlob(path, blob, errorMessage)) {
+        return false;
+    }
+    if (storedBytes) {
+        *storedBytes = blob.size();
+    }
+    return true;
+}
+
+bool BackupBlobStore::storeAsDelta(const QString &checksum, const QString &baseChecksum,
+                                   QString *errorMessage) const
+{
+    if (checksum.compare(baseChecksum, Qt::CaseInsensitive) == 0) {
+        return true;
+    }
+    const QString path = blobPath(checksum);
+    QByteArray blob;
+    if (checksum.size() < kMinChecksumLength || !readBlobFile(path, &blob)) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Unable to read backup file.");
+        }
+        return false;
+    }
+    // Raw blobs have no decoded payload, and deltas are never rewritten.
+    if (blob.at(5) != kKindContainer) {
+        return true;
+    }
+
+    Container target;
+    int depth = 0;
+    if (!readContainer(*this, blob, &target, &depth, 0)) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Backup data is corrupt.");
+        }
+        return false;
+    }
+    QByteArray baseBlob;
+    Container base;
+    int baseDepth = 0;
+    if (!readBlobFile(blobPath(baseChecksum), &baseBlob)
+        || !readContainer(*this, baseBlob, &base, &baseDepth, kMaxChainDepth)
+        || baseDepth + 1 >= kKeyframeInterval) {
+        return true;
+    }
+
+    const QByteArray ops = BinaryDelta::compute(base.payload, target.payload);
+    QByteArray check;
+    if (!BinaryDelta::apply(base.payload, ops, &check) || check != target.payload) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Backup delta failed verification.");
+        }
+        return false;
+    }
+    const QByteArray baseKey = baseChecksum.toLower().toLatin1();
+    QByteArray delta = blobHeader(kKindDelta);
+    appendLe32(&delta, static_cast<quint32>(baseDepth + 1));
+    appendLe32(&delta, static_cast<quint32>(baseKey.size()));
+    delta.append(baseKey);
+    appendLayout(&delta, target);
+    if (!appendPacked(&delta, ops)) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("LZ4 compression failed");
+        }
+        return false;
+    }
+    // A delta that saves little is not worth lengthening the chain for.
+    if (delta.size() * 2 > blob.size()) {
+        return true;
+    }
+    return writeBlob(path, delta, errorMessage);
+}
+
+QString BackupBlobStore::baseOf(const QString &checksum) const
+{
+    QFile file(blobPath(checksum));
+    if (checksum.size() < kMinChecksumLength || !file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    const QByteArray head = file.read(kBlobHeaderSize + 8);
+    if (head.size() < kBlobHeaderSize + 8 || !hasBlobHeader(head) || head.at(5) != kKindDelta) {
+        return QString();
+    }
+    const quint32 baseLength = readLe32(head.constData() + kBlobHeaderSize + 4);
+    if (baseLength > kMaxChecksumLength) {
+        return QString();
+    }
+    return QString::fromLatin1(file.read(baseLength));
+}
+
+qint64 BackupBlobStore::blobSize(const QString &checksum) const
+{
+    return QFileInfo(blobPath(checksum)).size();
+}
+
+bool BackupBlobStore::remove(const QString &checksum) const
+{
+    const QString path = blobPath(checksum);
+    if (checksum.size() < kMinChecksumLength || !QFile::remove(path)) {
+        return false;
+    }
+    QDir().rmdir(QFileInfo(path).absolutePath());
+    return true;
+}
+
+bool BackupBlobStore::load(const QString &checksum, QByteArray *hgBytes, QString *errorMessage) const
+{
+    QByteArray blob;
+    if (checksum.size() < kMinChecksumLength || !readBlobFile(blobPath(checksum), &blob)) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Unable to read backup file.");
+        }
+        return false;
+    }
+
+    QByteArray bytes;
+    if (blob.at(5) == kKindRaw) {
+        bytes = blob.mid(kBlobHeaderSize);
+    } else {
+        Container container;
+        int depth = 0;
+        if (!readContainer(*this, blob, &container, &depth, kMaxChainDepth)
+            || !rebuildContainer(container, &bytes)) {
+            if (errorMessage) {
+                *errorMessage = QStringLiteral("Backup data is corrupt or its base is missing.");
+            }
+            return false;
+        }
+    }
+    if (checksumFor(bytes).compare(checksum, Qt::CaseInsensitive) != 0) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Backup data failed checksum verification.");
+        }
+        return false;
+    }
+    *hgBytes = bytes;
+    return true;
+}
+
+QString BackupBlobStore::checksumFor(const QByteArray &bytes)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(bytes);
+    return QString::fromLatin1(hash.result().toHex());
+}
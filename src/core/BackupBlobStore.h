@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+// Content-addressed storage for backup bytes under <backup root>/blobs, keyed
+// by the SHA-256 of the original .hg file. A save that is already stored costs
+// nothing. New blobs keep the .hg container layout and the decoded payload
+// compressed as one LZ4 stream; the exact .hg bytes are rebuilt from that on
+// load. Saves whose rebuild would not reproduce the file byte for byte are
+// stored as-is instead. A stored blob can later be rewritten as a delta
+// against an earlier one, with a full keyframe kept at a fixed interval.
+class BackupBlobStore
+{
+public:
+    explicit BackupBlobStore(const QString &backupRoot);
+
+    QString blobPath(const QString &checksum) const;
+    bool contains(const QString &checksum) const;
+
+    // Stores hgBytes under checksum unless a blob already exists. storedBytes
+    // receives the bytes written to disk, 0 for a deduplicated save.
+    bool store(const QByteArray &hgBytes, const QString &checksum, qint64 *storedBytes,
+               QString *errorMessage) const;
+    // Replaces the blob for checksum with a binary delta of its decoded
+    // payload against baseChecksum's. Leaves it alone when the base has no
+    // payload, the chain is due a keyframe or the delta would save little.
+    // Reads and recompresses whole saves; call it off the GUI thread.
+    bool storeAsDelta(const QString &checksum, const QString &baseChecksum,
+                      QString *errorMessage) const;
+    // The blob a delta blob is applied to, or empty for a full blob.
+    QString baseOf(const QString &checksum) const;
+    qint64 blobSize(const QString &checksum) const;
+    bool remove(const QString &checksum) const;
+    // Rebuilds the original .hg bytes and checks them against checksum.
+    bool load(const QString &checksum, QByteArray *hgBytes, QString *errorMessage) const;
+
+    static QString checksumFor(const QByteArray &bytes);
+
+private:
+    QString blobRoot_;
+};
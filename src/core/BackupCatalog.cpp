@@ -0,0 +1,386 @@
+#include "core/BackupCatalog.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+constexpr char kCatalogMagic[4] = {'N', 'M', 'S', 'C'};
+constexpr int kCatalogHeaderSize = 8;
+constexpr char kCatalogVersion = 1;
+constexpr int kCatalogLockTimeoutMs = 10000;
+constexpr quint8 kRecordAdd = 1;
+constexpr quint8 kRecordRemove = 2;
+constexpr QDataStream::Version kStreamVersion = QDataStream::Qt_6_0;
+
+// The last three header bytes hold a generation picked at random by each
+// rewrite, so readers can tell a replaced file from one that only grew.
+QByteArray catalogHeader(quint32 generation)
+{
+    QByteArray out(kCatalogMagic, 4);
+    out.append(kCatalogVersion);
+    out.append(char(generation & 0xff));
+    out.append(char((generation >> 8) & 0xff));
+    out.append(char((generation >> 16) & 0xff));
+    return out;
+}
+
+bool isCatalogHeader(const QByteArray &header)
+{
+    return header.size() == kCatalogHeaderSize && header.startsWith(QByteArray(kCatalogMagic, 4))
+        && header.at(4) == kCatalogVersion;
+}
+
+// Serializes writers across processes; readers never take it.
+bool lockCatalog(QLockFile *lock, QString *errorMessage)
+{
+    if (lock->tryLock(kCatalogLockTimeoutMs)) {
+        return true;
+    }
+    if (errorMessage) {
+        *errorMessage = QStringLiteral("Backup index is locked by another process.");
+    }
+    return false;
+}
+
+QString relativeTo(const QDir &root, const QString &path)
+{
+    return path.isEmpty() ? QString() : root.relativeFilePath(path);
+}
+
+QString resolveFrom(const QDir &root, const QString &path)
+{
+    return path.isEmpty() ? QString() : QDir::cleanPath(root.filePath(path));
+}
+
+// Each record is a length-prefixed blob, so a reader can tell a complete
+// record from one cut short by an interrupted append.
+QByteArray frameRecord(const QByteArray &record)
+{
+    QByteArray framed;
+    QDataStream frame(&framed, QIODevice::WriteOnly);
+    frame.setVersion(kStreamVersion);
+    frame << record;
+    return framed;
+}
+
+QByteArray encodeRecord(const BackupEntry &entry, const QString &key, const QDir &root)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(kStreamVersion);
+    out << kRecordAdd << key << relativeTo(root, entry.metadataPath)
+        << relativeTo(root, entry.backupPath) << entry.sourcePath << entry.saveName
+        << entry.profileId << entry.slotId << entry.reason << entry.checksum
+        << entry.sourceMtimeMs << entry.backupTimeMs << entry.sizeBytes << entry.inBlobStore;
+    return frameRecord(record);
+}
+
+QByteArray encodeRemoval(const QString &metadataPath, const QDir &root)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(kStreamVersion);
+    out << kRecordRemove << relativeTo(root, metadataPath);
+    return frameRecord(record);
+}
+
+// Returns the record kind, or 0 for a malformed record. Removal records only
+// fill in entry->metadataPath.
+quint8 decodeRecord(const QByteArray &record, const QDir &root, BackupEntry *entry, QString *key)
+{
+    QDataStream in(record);
+    in.setVersion(kStreamVersion);
+    quint8 kind = 0;
+    in >> kind;
+    QString metadataPath;
+    if (kind == kRecordRemove) {
+        in >> metadataPath;
+        entry->metadataPath = resolveFrom(root, metadataPath);
+        return in.status() == QDataStream::Ok ? kind : 0;
+    }
+    if (kind != kRecordAdd) {
+        return 0;
+    }
+    QString backupPath;
+    in >> *key >> metadataPath >> backupPath >> entry->sourcePath >> entry->saveName
+        >> entry->profileId >> entry->slotId >> entry->reason >> entry->checksum
+        >> entry->sourceMtimeMs >> entry->backupTimeMs >> entry->sizeBytes >> entry->inBlobStore;
+    entry->metadataPath = resolveFrom(root, metadataPath);
+    entry->backupPath = resolveFrom(root, backupPath);
+    return in.status() == QDataStream::Ok ? kind : 0;
+}
+
+BackupCatalog::BackupCatalog(const QString &backupRoot)
+    : root_(backupRoot)
+    , path_(QDir(backupRoot).filePath(QStringLiteral("catalog.idx")))
+    , lockPath_(path_ + QStringLiteral(".lock"))
+{
+}
+
+bool BackupCatalog::isUsable()
+{
+    QMutexLocker locker(&mutex_);
+    refreshLocked();
+    return readOffset_ >= kCatalogHeaderSize;
+}
+
+bool BackupCatalog::append(const BackupEntry &entry, QString *errorMessage)
+{
+    const QString key = sourceKey(entry.sourcePath);
+    QMutexLocker locker(&mutex_);
+    if (!appendLocked(encodeRecord(entry, key, QDir(root_)), errorMessage)) {
+        return false;
+    }
+    addLocked(entry, key);
+    return true;
+}
+
+bool BackupCatalog::appendRemovals(const QStringList &metadataPaths, QString *errorMessage)
+{
+    const QDir root(root_);
+    QByteArray records;
+    QSet<QString> removed;
+    for (const QString &path : metadataPaths) {
+        records.append(encodeRemoval(path, root));
+        removed.insert(QDir::cleanPath(path));
+    }
+    QMutexLocker locker(&mutex_);
+    if (!appendLocked(records, errorMessage)) {
+        return false;
+    }
+    removeLocked(removed);
+    return true;
+}
+
+bool BackupCatalog::rewrite(QList<BackupEntry> entries, QString *errorMessage)
+{
+    QMutexLocker locker(&mutex_);
+    QDir().mkpath(root_);
+    QLockFile lock(lockPath_);
+    if (!lockCatalog(&lock, errorMessage)) {
+        return false;
+    }
+    return rewriteLocked(std::move(entries), errorMessage);
+}
+
+bool BackupCatalog::compact(QString *errorMessage)
+{
+    QMutexLocker locker(&mutex_);
+    QLockFile lock(lockPath_);
+    if (!lockCatalog(&lock, errorMessage)) {
+        return false;
+    }
+    // Refreshing under the lock keeps records another process appended.
+    refreshLocked();
+    if (readOffset_ < kCatalogHeaderSize) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Unable to open backup index.");
+        }
+        return false;
+    }
+    return rewriteLocked(entries_, errorMessage);
+}
+
+bool BackupCatalog::rewriteLocked(QList<BackupEntry> entries, QString *errorMessage)
+{
+    std::sort(entries.begin(), entries.end(), [](const BackupEntry &a, const BackupEntry &b) {
+        return a.backupTimeMs < b.backupTimeMs;
+    });
+
+    // Backups share a handful of source paths; canonicalize each once.
+    const QDir root(root_);
+    QHash<QString, QString> keys;
+    QList<QString> entryKeys;
+    entryKeys.reserve(entries.size());
+    // Readers that cached the current file must see a different generation.
+    QFile current(path_);
+    const QByteArray previous = current.open(QIODevice::ReadOnly) ? current.read(kCatalogHeaderSize)
+                                                                  : QByteArray();
+    current.close();
+    QByteArray header;
+    do {
+        header = catalogHeader(QRandomGenerator::global()->bounded(1u << 24));
+    } while (header == previous || header == header_);
+    QByteArray data = header;
+    for (const BackupEntry &entry : entries) {
+        auto it = keys.constFind(entry.sourcePath);
+        if (it == keys.constEnd()) {
+            it = keys.insert(entry.sourcePath, sourceKey(entry.sourcePath));
+        }
+        entryKeys.append(it.value());
+        data.append(encodeRecord(entry, it.value(), root));
+    }
+
+    QSaveFile file(path_);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Failed to write backup index.");
+        }
+        return false;
+    }
+    resetLocked();
+    for (int i = 0; i < entries.size(); ++i) {
+        addLocked(entries.at(i), entryKeys.at(i));
+    }
+    header_ = header;
+    readOffset_ = data.size();
+    return true;
+}
+
+QList<BackupEntry> BackupCatalog::entries()
+{
+    QMutexLocker locker(&mutex_);
+    refreshLocked();
+    QList<BackupEntry> out;
+    out.reserve(entries_.size());
+    for (auto it = entries_.crbegin(); it != entries_.crend(); ++it) {
+        out.append(*it);
+    }
+    return out;
+}
+
+QList<BackupEntry> BackupCatalog::entriesForSource(const QString &sourcePath)
+{
+    const QString key = sourceKey(sourcePath);
+    QMutexLocker locker(&mutex_);
+    refreshLocked();
+    const QList<int> indices = bySource_.value(key);
+    QList<BackupEntry> out;
+    out.reserve(indices.size());
+    for (auto it = indices.crbegin(); it != indices.crend(); ++it) {
+        out.append(entries_.at(*it));
+    }
+    return out;
+}
+
+QString BackupCatalog::sourceKey(const QString &path)
+{
+    if (path.isEmpty()) {
+        return QString();
+    }
+    QFileInfo info(path);
+    QString key = info.canonicalFilePath();
+    if (key.isEmpty()) {
+        key = info.absoluteFilePath();
+    }
+    return key;
+}
+
+void BackupCatalog::refreshLocked()
+{
+    QFile file(path_);
+    if (!file.open(QIODevice::ReadOnly)) {
+        resetLocked();
+        return;
+    }
+    const QByteArray header = file.read(kCatalogHeaderSize);
+    if (!isCatalogHeader(header)) {
+        resetLocked();
+        return;
+    }
+    // A new generation means another writer replaced the file, whatever its
+    // size; the records read so far no longer line up with it.
+    if (readOffset_ == 0 || header != header_ || file.size() < readOffset_) {
+        resetLocked();
+        header_ = header;
+        readOffset_ = kCatalogHeaderSize;
+    }
+    if (file.size() == readOffset_ || !file.seek(readOffset_)) {
+        return;
+    }
+
+    const QDir root(root_);
+    QDataStream in(&file);
+    in.setVersion(kStreamVersion);
+    while (!in.atEnd()) {
+        QByteArray record;
+        in >> record;
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        readOffset_ = file.pos();
+        BackupEntry entry;
+        QString key;
+        const quint8 kind = decodeRecord(record, root, &entry, &key);
+        if (kind == kRecordAdd) {
+            addLocked(entry, key);
+        } else if (kind == kRecordRemove) {
+            removeLocked(QSet<QString>{entry.metadataPath});
+        }
+    }
+}
+
+bool BackupCatalog::appendLocked(const QByteArray &records, QString *errorMessage)
+{
+    QLockFile lock(lockPath_);
+    if (!lockCatalog(&lock, errorMessage)) {
+        return false;
+    }
+    refreshLocked();
+    QFile file(path_);
+    if (readOffset_ < kCatalogHeaderSize || !file.open(QIODevice::ReadWrite)) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Unable to open backup index.");
+        }
+        return false;
+    }
+    // With the lock held and every complete record read, anything past
+    // readOffset_ is a torn append; drop it so the new records stay readable.
+    if (file.size() != readOffset_) {
+        file.resize(readOffset_);
+    }
+    if (!file.seek(readOffset_) || file.write(records) != records.size() || !file.flush()) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Failed to update backup index.");
+        }
+        return false;
+    }
+    readOffset_ += records.size();
+    return true;
+}
+
+void BackupCatalog::removeLocked(const QSet<QString> &metadataPaths)
+{
+    QList<BackupEntry> entries;
+    QList<QString> keys;
+    entries.reserve(entries_.size());
+    keys.reserve(keys_.size());
+    for (int i = 0; i < entries_.size(); ++i) {
+        if (!metadataPaths.contains(QDir::cleanPath(entries_.at(i).metadataPath))) {
+            entries.append(entries_.at(i));
+            keys.append(keys_.at(i));
+        }
+    }
+    if (entries.size() == entries_.size()) {
+        return;
+    }
+    entries_.clear();
+    keys_.clear();
+    bySource_.clear();
+    for (int i = 0; i < entries.size(); ++i) {
+        addLocked(entries.at(i), keys.at(i));
+    }
+}
+
+void BackupCatalog::resetLocked()
+{
+    header_.clear();
+    readOffset_ = 0;
+    entries_.clear();
+    keys_.clear();
+    bySource_.clear();
+}
+
+void BackupCatalog::addLocked(const BackupEntry &entry, const QString &key)
+{
+    bySource_[key].append(entries_.size());
+    entries_.append(entry);
+    keys_.append(key);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "core/BackupManager.h"
+
+// Append-only index of the backups under a backup root, so listing does not
+// open every sidecar. Records are read back incrementally, which also picks
+// up backups taken by another running instance; writers from any process
+// serialize on a lock file next to the index. The sidecars stay the source
+// of truth; rewrite() regenerates the index from them.
+class BackupCatalog
+{
+public:
+    explicit BackupCatalog(const QString &backupRoot);
+
+    // False when the index file is missing or unreadable and needs a rewrite.
+    bool isUsable();
+    bool append(const BackupEntry &entry, QString *errorMessage);
+    bool appendRemovals(const QStringList &metadataPaths, QString *errorMessage);
+    bool rewrite(QList<BackupEntry> entries, QString *errorMessage);
+    // Rewrites the current records without the removed ones.
+    bool compact(QString *errorMessage);
+
+    // Both newest first. entriesForSource only touches the matching records.
+    QList<BackupEntry> entries();
+    QList<BackupEntry> entriesForSource(const QString &sourcePath);
+
+    // Canonical form of a save path, falling back to the absolute path for
+    // files that no longer exist.
+    static QString sourceKey(const QString &path);
+
+private:
+    void refreshLocked();
+    bool appendLocked(const QByteArray &records, QString *errorMessage);
+    bool rewriteLocked(QList<BackupEntry> entries, QString *errorMessage);
+    void removeLocked(const QSet<QString> &metadataPaths);
+    void resetLocked();
+    void addLocked(const BackupEntry &entry, const QString &key);
+
+    QString root_;
+    QString path_;
+    QString lockPath_;
+    QMutex mutex_;
+    QByteArray header_;
+    qint64 readOffset_ = 0;
+    QList<BackupEntry> entries_;
+    QList<QString> keys_;
+    QHash<QString, QList<int>> bySource_;
+};
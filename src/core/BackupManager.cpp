@@ -1,9 +1,11 @@
 #include "core/BackupManager.h"
 
+#include "core/BackupBlobStore.h"
+#include "core/BackupCatalog.h"
+#include "core/BackupRetention.h"
 #include "core/SaveGameLocator.h"
 
 #include <QCoreApplication>
-#include <QCryptographicHash>
 #include <QDateTime>
 #include <QDir>
 #include <QDirIterator>
@@ -11,7 +13,9 @@
 #include <QFileInfo>
 #include <QJsonDocument>
 #include <QSaveFile>
+#include <QSet>
 #include <QStandardPaths>
+#include <QThreadPool>
 
 namespace {
 constexpr int kSecondsPerMinute = 60;
@@ -20,12 +24,56 @@ constexpr int kHoursPerDay = 24;
 constexpr qint64 kBytesPerKiB = 1024;
 constexpr qint64 kBytesPerMiB = 1024 * 1024;
 constexpr qint64 kBytesPerGiB = 1024 * 1024 * 1024;
+constexpr int kPruneBatchSize = 100;
+// profiles/<profile>/slots/<slot>/YYYY/MM/DD holds the sidecars.
+constexpr int kDateFolderDepth = 3;
 
 QString normalizeSeparators(const QString &value)
 {
     QString out = QDir::cleanPath(value);
     return out.replace("\\", "/");
 }
+
+// Delta encoding reads and recompresses whole saves, so it runs on one
+// background thread in the order backups were taken.
+QThreadPool *deltaPool()
+{
+    static QThreadPool *pool = [] {
+        static QThreadPool instance;
+        instance.setMaxThreadCount(1);
+        return &instance;
+    }();
+    return pool;
+}
+
+void removeEmptyFolders(const QString &filePath)
+{
+    QDir dir = QFileInfo(filePath).absoluteDir();
+    for (int i = 0; i < kDateFolderDepth; ++i) {
+        const QString name = dir.dirName();
+        if (!dir.cdUp() || !dir.rmdir(name)) {
+            return;
+        }
+    }
+}
+
+QString readChainHead(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromLatin1(file.readAll()).trimmed();
+}
+
+void writeChainHead(const QString &path, const QString &checksum)
+{
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(checksum.toLatin1());
+        file.commit();
+    }
+}
 }
 
 BackupManager::BackupManager(const QString &rootPath)
@@ -34,6 +82,7 @@ BackupManager::BackupManager(const QString &rootPath)
     if (rootPath_.isEmpty()) {
         rootPath_ = defaultRootPath();
     }
+    catalog_ = std::make_shared<BackupCatalog>(rootPath_);
 }
 
 QString BackupManager::rootPath() const
@@ -44,6 +93,7 @@ QString BackupManager::rootPath() const
 void BackupManager::setRootPath(const QString &path)
 {
     rootPath_ = path;
+    catalog_ = std::make_shared<BackupCatalog>(rootPath_);
 }
 
 bool BackupManager::createBackup(const QString &sourcePath,
@@ -82,8 +132,7 @@ bool BackupManager::createBackup(const QString &sourcePath,
     }
     QString timestamp = QDateTime::currentDateTimeUtc().toString(QStringLiteral("yyyyMMdd_HHmmss"));
     QString backupFileName = QStringLiteral("%1_%2.%3").arg(baseName, timestamp, extension);
-    QString backupPath = dir.filePath(backupFileName);
-    QString metadataPath = backupPath + QStringLiteral(".json");
+    QString metadataPath = dir.filePath(backupFileName + QStringLiteral(".json"));
 
     QFile sourceFile(sourcePath);
     if (!sourceFile.open(QIODevice::ReadOnly)) {
@@ -101,32 +150,27 @@ bool BackupManager::createBackup(const QString &sourcePath,
         return false;
     }
 
-    QSaveFile outFile(backupPath);
-    if (!outFile.open(QIODevice::WriteOnly)) {
-        if (errorMessage) {
-            *errorMessage = QStringLiteral("Unable to write backup file.");
-        }
-        return false;
-    }
-    if (outFile.write(bytes) != bytes.size()) {
-        if (errorMessage) {
-            *errorMessage = QStringLiteral("Failed to write backup file.");
-        }
-        return false;
-    }
-    if (!outFile.commit()) {
-        if (errorMessage) {
-            *errorMessage = QStringLiteral("Failed to finalize backup file.");
-        }
+    QString checksum = BackupBlobStore::checksumFor(bytes);
+    BackupBlobStore store(rootPath_);
+    qint64 storedBytes = 0;
+    if (!store.store(bytes, checksum, &storedBytes, errorMessage)) {
         return false;
     }
 
-    QCryptographicHash hash(QCryptographicHash::Sha256);
-    hash.addData(bytes);
-    QString checksum = QString::fromLatin1(hash.result().toHex());
+    // Each slot's newest blob is the base for the next one. A fresh blob is
+    // written whole first and turned into a delta in the background.
+    const QString headPath = QDir(slotFolderFor(rootPath_, profileId, slotId))
+                                 .filePath(QStringLiteral("chain-head"));
+    const QString previous = readChainHead(headPath);
+    if (storedBytes > 0 && !previous.isEmpty() && previous != checksum) {
+        const QString root = rootPath_;
+        deltaPool()->start([root, checksum, previous]() {
+            BackupBlobStore(root).storeAsDelta(checksum, previous, nullptr);
+        });
+    }
+    writeChainHead(headPath, checksum);
 
     BackupEntry entry;
-    entry.backupPath = backupPath;
     entry.metadataPath = metadataPath;
     entry.sourcePath = sourcePath;
     entry.saveName = info.fileName();
@@ -137,9 +181,12 @@ bool BackupManager::createBackup(const QString &sourcePath,
     entry.sizeBytes = bytes.size();
     entry.reason = reason;
     entry.checksum = checksum;
+    entry.inBlobStore = true;
 
+    // The sidecar only references the blob; the save bytes live once in the
+    // store however many backups point at them.
     QJsonObject meta;
-    meta.insert(QStringLiteral("backupFile"), QFileInfo(backupPath).fileName());
+    meta.insert(QStringLiteral("storage"), QStringLiteral("blob"));
     meta.insert(QStringLiteral("sourcePath"), entry.sourcePath);
     meta.insert(QStringLiteral("saveName"), entry.saveName);
     meta.insert(QStringLiteral("profileId"), entry.profileId);
@@ -167,6 +214,12 @@ bool BackupManager::createBackup(const QString &sourcePath,
         return false;
     }
 
+    // The index is a cache of the sidecars, so failing to update it does not
+    // fail the backup; a missing index is rebuilt from them.
+    if (!catalog_->append(entry, nullptr)) {
+        rebuildCatalog(nullptr);
+    }
+
     if (outEntry) {
         *outEntry = entry;
     }
@@ -175,54 +228,31 @@ bool BackupManager::createBackup(const QString &sourcePath,
 
 QList<BackupEntry> BackupManager::listBackups(QString *errorMessage) const
 {
-    QList<BackupEntry> entries;
-    QDir root(rootPath_);
-    if (!root.exists()) {
-        return entries;
+    if (!ensureCatalog(errorMessage)) {
+        return QList<BackupEntry>();
     }
+    return catalog_->entries();
+}
 
-    QDirIterator it(rootPath_, QStringList() << QStringLiteral("*.json"),
-                    QDir::Files, QDirIterator::Subdirectories);
-    while (it.hasNext()) {
-        QString metadataPath = it.next();
-        QFile file(metadataPath);
-        if (!file.open(QIODevice::ReadOnly)) {
-            continue;
-        }
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
-        file.close();
-        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-            continue;
-        }
-
-        BackupEntry entry = entryFromMetadata(doc.object(), metadataPath);
-        if (entry.backupPath.isEmpty()) {
-            QString guessed = metadataPath;
-            if (guessed.endsWith(QStringLiteral(".json"))) {
-                guessed.chop(5);
-            }
-            entry.backupPath = guessed;
-        }
-        QFileInfo backupInfo(entry.backupPath);
-        if (entry.sizeBytes <= 0 && backupInfo.exists()) {
-            entry.sizeBytes = backupInfo.size();
-        }
-        entries.append(entry);
+QList<BackupEntry> BackupManager::listBackupsFor(const QString &sourcePath, QString *errorMessage) const
+{
+    if (!ensureCatalog(errorMessage)) {
+        return QList<BackupEntry>();
     }
+    return catalog_->entriesForSource(sourcePath);
+}
 
-    std::sort(entries.begin(), entries.end(), [](const BackupEntry &a, const BackupEntry &b) {
-        return a.backupTimeMs > b.backupTimeMs;
-    });
-
-    if (errorMessage) {
-        errorMessage->clear();
-    }
-    return entries;
+bool BackupManager::rebuildCatalog(QString *errorMessage) const
+{
+    return catalog_->rewrite(scanMetadata(), errorMessage);
 }
 
-bool BackupManager::restoreBackup(const BackupEntry &entry, const QString &targetPath, QString *errorMessage) const
+bool BackupManager::readBackup(const BackupEntry &entry, QByteArray *bytes, QString *errorMessage) const
 {
+    if (entry.inBlobStore) {
+        return BackupBlobStore(rootPath_).load(entry.checksum, bytes, errorMessage);
+    }
+
     QFile source(entry.backupPath);
     if (!source.open(QIODevice::ReadOnly)) {
         if (errorMessage) {
@@ -230,15 +260,23 @@ bool BackupManager::restoreBackup(const BackupEntry &entry, const QString &targe
         }
         return false;
     }
-
-    QByteArray bytes = source.readAll();
+    *bytes = source.readAll();
     source.close();
-    if (bytes.isEmpty()) {
+    if (bytes->isEmpty()) {
         if (errorMessage) {
             *errorMessage = QStringLiteral("Backup file is empty.");
         }
         return false;
     }
+    return true;
+}
+
+bool BackupManager::restoreBackup(const BackupEntry &entry, const QString &targetPath, QString *errorMessage) const
+{
+    QByteArray bytes;
+    if (!readBackup(entry, &bytes, errorMessage)) {
+        return false;
+    }
 
     QSaveFile target(targetPath);
     if (!target.open(QIODevice::WriteOnly)) {
@@ -262,6 +300,134 @@ bool BackupManager::restoreBackup(const BackupEntry &entry, const QString &targe
     return true;
 }
 
+bool BackupManager::pruneBackups(const RetentionPolicy &policy, bool dryRun, RetentionReport *report) const
+{
+    RetentionReport result;
+    result.dryRun = dryRun;
+    QList<BackupEntry> entries;
+    if (!entriesForRemoval(&entries, &result.errorMessage)) {
+        if (report) {
+            *report = result;
+        }
+        return false;
+    }
+    const qint64 now = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
+    result.removed = BackupRetention::selectExpired(entries, policy, now);
+    removeEntries(entries, &result);
+    if (report) {
+        *report = result;
+    }
+    return result.errorMessage.isEmpty();
+}
+
+bool BackupManager::removeBackups(const QList<BackupEntry> &confirmed, RetentionReport *report) const
+{
+    RetentionReport result;
+    result.dryRun = false;
+    QList<BackupEntry> entries;
+    if (!entriesForRemoval(&entries, &result.errorMessage)) {
+        if (report) {
+            *report = result;
+        }
+        return false;
+    }
+    // Only confirmed backups that are still catalogued go; blobs shared with
+    // anything kept, including backups taken since, stay live below.
+    QSet<QString> wanted;
+    for (const BackupEntry &entry : confirmed) {
+        wanted.insert(QDir::cleanPath(entry.metadataPath));
+    }
+    for (const BackupEntry &entry : entries) {
+        if (wanted.contains(QDir::cleanPath(entry.metadataPath))) {
+            result.removed.append(entry);
+        }
+    }
+    removeEntries(entries, &result);
+    if (report) {
+        *report = result;
+    }
+    return result.errorMessage.isEmpty();
+}
+
+bool BackupManager::entriesForRemoval(QList<BackupEntry> *entries, QString *errorMessage) const
+{
+    if (!ensureCatalog(errorMessage)) {
+        return false;
+    }
+    // A pending delta could rewrite a blob against a base this pass deletes.
+    deltaPool()->waitForDone();
+    *entries = catalog_->entries();
+    return true;
+}
+
+void BackupManager::removeEntries(const QList<BackupEntry> &entries, RetentionReport *result) const
+{
+    result->keptCount = entries.size() - result->removed.size();
+
+    QSet<QString> expiredPaths;
+    for (const BackupEntry &entry : result->removed) {
+        expiredPaths.insert(entry.metadataPath);
+    }
+    BackupBlobStore store(rootPath_);
+    QSet<QString> liveBlobs;
+    QStringList pending;
+    for (const BackupEntry &entry : entries) {
+        if (entry.inBlobStore && !expiredPaths.contains(entry.metadataPath)) {
+            const QString checksum = entry.checksum.toLower();
+            if (!liveBlobs.contains(checksum)) {
+                liveBlobs.insert(checksum);
+                pending.append(checksum);
+            }
+        }
+    }
+    while (!pending.isEmpty()) {
+        const QString base = store.baseOf(pending.takeLast()).toLower();
+        if (!base.isEmpty() && !liveBlobs.contains(base)) {
+            liveBlobs.insert(base);
+            pending.append(base);
+        }
+    }
+
+    QSet<QString> deadBlobs;
+    for (const BackupEntry &entry : result->removed) {
+        result->reclaimedBytes += QFileInfo(entry.metadataPath).size();
+        if (!entry.inBlobStore) {
+            result->reclaimedBytes += QFileInfo(entry.backupPath).size();
+            continue;
+        }
+        const QString checksum = entry.checksum.toLower();
+        if (!liveBlobs.contains(checksum) && !deadBlobs.contains(checksum)) {
+            deadBlobs.insert(checksum);
+            result->reclaimedBytes += store.blobSize(checksum);
+        }
+    }
+    result->removedBlobs = deadBlobs.size();
+
+    if (!result->dryRun && !result->removed.isEmpty()) {
+        // Each batch is recorded in the index before the next starts, so an
+        // interrupted pass leaves the index matching the sidecars on disk.
+        for (int start = 0; start < result->removed.size(); start += kPruneBatchSize) {
+            QStringList batch;
+            const int end = qMin(start + kPruneBatchSize, result->removed.size());
+            for (int i = start; i < end; ++i) {
+                const BackupEntry &entry = result->removed.at(i);
+                QFile::remove(entry.metadataPath);
+                if (!entry.inBlobStore && !entry.backupPath.isEmpty()) {
+                    QFile::remove(entry.backupPath);
+                }
+                removeEmptyFolders(entry.metadataPath);
+                batch.append(entry.metadataPath);
+            }
+            catalog_->appendRemovals(batch, &result->errorMessage);
+        }
+        for (const QString &checksum : deadBlobs) {
+            store.remove(checksum);
+        }
+        // Compacts the removal records away.
+        catalog_->compact(nullptr);
+    }
+}
+
 QString BackupManager::defaultRootPath()
 {
     QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
@@ -337,20 +503,25 @@ QString BackupManager::slotIdForSlot(const SaveSlot *slot, const QString &source
     return sanitizePathComponent(info.completeBaseName());
 }
 
+QString BackupManager::slotFolderFor(const QString &root,
+                                     const QString &profileId,
+                                     const QString &slotId)
+{
+    return QDir(root).filePath(QStringLiteral("profiles/%1/slots/%2")
+                                   .arg(sanitizePathComponent(profileId),
+                                        sanitizePathComponent(slotId)));
+}
+
 QString BackupManager::backupFolderFor(const QString &root,
                                        const QString &profileId,
                                        const QString &slotId,
                                        const QDate &date)
 {
-    QDir rootDir(root);
     QString datePath = QStringLiteral("%1/%2/%3")
                            .arg(date.year(), 4, 10, QLatin1Char('0'))
                            .arg(date.month(), 2, 10, QLatin1Char('0'))
                            .arg(date.day(), 2, 10, QLatin1Char('0'));
-    return rootDir.filePath(QStringLiteral("profiles/%1/slots/%2/%3")
-                                .arg(sanitizePathComponent(profileId),
-                                     sanitizePathComponent(slotId),
-                                     datePath));
+    return QDir(slotFolderFor(root, profileId, slotId)).filePath(datePath);
 }
 
 BackupEntry BackupManager::entryFromMetadata(const QJsonObject &obj, const QString &metadataPath)
@@ -366,6 +537,7 @@ BackupEntry BackupManager::entryFromMetadata(const QJsonObject &obj, const QStri
     entry.sizeBytes = static_cast<qint64>(obj.value(QStringLiteral("sizeBytes")).toDouble());
     entry.reason = obj.value(QStringLiteral("reason")).toString();
     entry.checksum = obj.value(QStringLiteral("checksum")).toString();
+    entry.inBlobStore = obj.value(QStringLiteral("storage")).toString() == QStringLiteral("blob");
 
     QString backupFile = obj.value(QStringLiteral("backupFile")).toString();
     if (!backupFile.isEmpty()) {
@@ -373,3 +545,61 @@ BackupEntry BackupManager::entryFromMetadata(const QJsonObject &obj, const QStri
     }
     return entry;
 }
+
+QList<BackupEntry> BackupManager::scanMetadata() const
+{
+    QList<BackupEntry> entries;
+    QDir root(rootPath_);
+    if (!root.exists()) {
+        return entries;
+    }
+
+    QDirIterator it(rootPath_, QStringList() << QStringLiteral("*.json"),
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString metadataPath = it.next();
+        QFile file(metadataPath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+        file.close();
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            continue;
+        }
+
+        BackupEntry entry = entryFromMetadata(doc.object(), metadataPath);
+        if (entry.inBlobStore) {
+            entries.append(entry);
+            continue;
+        }
+        if (entry.backupPath.isEmpty()) {
+            QString guessed = metadataPath;
+            if (guessed.endsWith(QStringLiteral(".json"))) {
+                guessed.chop(5);
+            }
+            entry.backupPath = guessed;
+        }
+        QFileInfo backupInfo(entry.backupPath);
+        if (entry.sizeBytes <= 0 && backupInfo.exists()) {
+            entry.sizeBytes = backupInfo.size();
+        }
+        entries.append(entry);
+    }
+    return entries;
+}
+
+bool BackupManager::ensureCatalog(QString *errorMessage) const
+{
+    if (errorMessage) {
+        errorMessage->clear();
+    }
+    if (catalog_->isUsable()) {
+        return true;
+    }
+    if (!QDir(rootPath_).exists()) {
+        return false;
+    }
+    return rebuildCatalog(errorMessage);
+}
@@ -1,14 +1,21 @@
 #pragma once
 
+#include <QByteArray>
 #include <QDateTime>
 #include <QList>
 #include <QJsonObject>
 #include <QMetaType>
 #include <QString>
+#include <memory>
 
+class BackupCatalog;
+struct RetentionPolicy;
+struct RetentionReport;
 struct SaveSlot;
 
 struct BackupEntry {
+    // Set only for backups written as full copies; newer backups live in the
+    // blob store under checksum and are reached through BackupManager.
     QString backupPath;
     QString metadataPath;
     QString sourcePath;
@@ -20,6 +27,7 @@ struct BackupEntry {
     qint64 sizeBytes = 0;
     QString reason;
     QString checksum;
+    bool inBlobStore = false;
 };
 
 Q_DECLARE_METATYPE(BackupEntry)
@@ -38,8 +46,20 @@ public:
                       BackupEntry *outEntry,
                       QString *errorMessage) const;
 
+    // Listings come from the backup index, which is rebuilt from the sidecars
+    // when it is missing and otherwise only through rebuildCatalog().
     QList<BackupEntry> listBackups(QString *errorMessage = nullptr) const;
+    QList<BackupEntry> listBackupsFor(const QString &sourcePath, QString *errorMessage = nullptr) const;
+    bool rebuildCatalog(QString *errorMessage = nullptr) const;
+    bool readBackup(const BackupEntry &entry, QByteArray *bytes, QString *errorMessage) const;
     bool restoreBackup(const BackupEntry &entry, const QString &targetPath, QString *errorMessage) const;
+    // Removes the backups policy expires, in batches, along with store blobs
+    // that no remaining backup or delta chain needs. With dryRun nothing is
+    // deleted and report only describes what would be. Meant for a worker.
+    bool pruneBackups(const RetentionPolicy &policy, bool dryRun, RetentionReport *report) const;
+    // Removes exactly the confirmed backups, typically a dry run's report,
+    // skipping any no longer in the index and keeping blobs still in use.
+    bool removeBackups(const QList<BackupEntry> &confirmed, RetentionReport *report) const;
 
     static QString defaultRootPath();
     static QString formatSize(qint64 bytes);
@@ -49,11 +69,21 @@ private:
     static QString sanitizePathComponent(const QString &value);
     static QString profileIdForSlot(const SaveSlot *slot, const QString &sourcePath);
     static QString slotIdForSlot(const SaveSlot *slot, const QString &sourcePath);
+    static QString slotFolderFor(const QString &root,
+                                 const QString &profileId,
+                                 const QString &slotId);
     static QString backupFolderFor(const QString &root,
                                    const QString &profileId,
                                    const QString &slotId,
                                    const QDate &date);
     static BackupEntry entryFromMetadata(const QJsonObject &obj, const QString &metadataPath);
+    QList<BackupEntry> scanMetadata() const;
+    bool ensureCatalog(QString *errorMessage) const;
+    bool entriesForRemoval(QList<BackupEntry> *entries, QString *errorMessage) const;
+    // Deletes result->removed, unless result->dryRun, and fills in the rest of
+    // result from entries, the full catalog.
+    void removeEntries(const QList<BackupEntry> &entries, RetentionReport *result) const;
 
     QString rootPath_;
+    std::shared_ptr<BackupCatalog> catalog_;
 };
@@ -0,0 +1,166 @@
+#include "core/BackupQueue.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+
+BackupQueue::BackupQueue(QObject *parent)
+    : QObject(parent)
+{
+    pool_.setMaxThreadCount(1);
+}
+
+BackupQueue::~BackupQueue()
+{
+    pool_.waitForDone();
+}
+
+void BackupQueue::requestBackup(const BackupManager &manager, const QString &sourcePath,
+                                const QList<SaveSlot> &slots, const QString &reason)
+{
+    if (sourcePath.isEmpty()) {
+        return;
+    }
+    {
+        QMutexLocker locker(&mutex_);
+        if (waiting_.contains(sourcePath)) {
+            return;
+        }
+        waiting_.insert(sourcePath);
+    }
+
+    ++pendingJobs_;
+    pool_.start([this, manager, sourcePath, slots, reason]() {
+        {
+            QMutexLocker locker(&mutex_);
+            waiting_.remove(sourcePath);
+        }
+        const QFileInfo info(sourcePath);
+        const qint64 mtime = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+        bool skipped = mtime < 0;
+        if (!skipped) {
+            QMutexLocker locker(&mutex_);
+            skipped = backedUpMtime_.value(sourcePath, -1) == mtime;
+        }
+
+        BackupEntry entry;
+        QString error;
+        bool ok = false;
+        if (!skipped) {
+            ok = manager.createBackup(sourcePath, SaveGameLocator::findSlotForFile(slots, sourcePath),
+                                      reason, &entry, &error);
+            if (ok) {
+                QMutexLocker locker(&mutex_);
+                backedUpMtime_.insert(sourcePath, mtime);
+            }
+        }
+        QMetaObject::invokeMethod(this, [this, skipped, ok, entry, sourcePath, error]() {
+            finishJob();
+            if (skipped) {
+                return;
+            }
+            if (ok) {
+                emit backupCreated(entry);
+            } else {
+                emit backupFailed(sourcePath, error);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void BackupQueue::requestRestore(const BackupManager &manager, const BackupEntry &entry,
+                                 const QString &targetPath, const QList<SaveSlot> &slots)
+{
+    ++pendingJobs_;
+    pool_.start([this, manager, entry, targetPath, slots]() {
+        BackupEntry preRestore;
+        QString error;
+        bool backedUp = false;
+        if (QFileInfo::exists(targetPath)) {
+            backedUp = manager.createBackup(targetPath, SaveGameLocator::findSlotForFile(slots, targetPath),
+                                            QStringLiteral("pre-restore"), &preRestore, &error);
+        }
+        error.clear();
+        const bool ok = manager.restoreBackup(entry, targetPath, &error);
+        {
+            QMutexLocker locker(&mutex_);
+            backedUpMtime_.remove(targetPath);
+        }
+        QMetaObject::invokeMethod(this, [this, backedUp, preRestore, targetPath, ok, error]() {
+            finishJob();
+            if (backedUp) {
+                emit backupCreated(preRestore);
+            }
+            emit restoreFinished(targetPath, ok, error);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void BackupQueue::requestExtract(const BackupManager &manager, const BackupEntry &entry,
+                                 const QString &targetPath)
+{
+    ++pendingJobs_;
+    pool_.start([this, manager, entry, targetPath]() {
+        QString error;
+        const bool ok = manager.restoreBackup(entry, targetPath, &error);
+        QMetaObject::invokeMethod(this, [this, entry, targetPath, ok, error]() {
+            finishJob();
+            emit extractFinished(entry, targetPath, ok, error);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void BackupQueue::requestRescan(const BackupManager &manager)
+{
+    ++pendingJobs_;
+    pool_.start([this, manager]() {
+        QString error;
+        const bool ok = manager.rebuildCatalog(&error);
+        QMetaObject::invokeMethod(this, [this, ok, error]() {
+            finishJob();
+            emit rescanFinished(ok, error);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void BackupQueue::requestPrune(const BackupManager &manager, const RetentionPolicy &policy, bool dryRun)
+{
+    ++pendingJobs_;
+    pool_.start([this, manager, policy, dryRun]() {
+        RetentionReport report;
+        manager.pruneBackups(policy, dryRun, &report);
+        QMetaObject::invokeMethod(this, [this, report]() {
+            finishJob();
+            emit pruneFinished(report);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void BackupQueue::requestRemove(const BackupManager &manager, const QList<BackupEntry> &confirmed)
+{
+    ++pendingJobs_;
+    pool_.start([this, manager, confirmed]() {
+        RetentionReport report;
+        manager.removeBackups(confirmed, &report);
+        QMetaObject::invokeMethod(this, [this, report]() {
+            finishJob();
+            emit pruneFinished(report);
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool BackupQueue::isIdle() const
+{
+    return pendingJobs_ == 0;
+}
+
+void BackupQueue::drain()
+{
+    pool_.waitForDone();
+}
+
+void BackupQueue::finishJob()
+{
+    if (pendingJobs_ > 0) {
+        --pendingJobs_;
+    }
+}
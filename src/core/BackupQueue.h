@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+#include "core/BackupManager.h"
+#include "core/BackupRetention.h"
+#include "core/SaveGameLocator.h"
+
+// Runs backups, restores and pruning on one background thread, in the order
+// they were requested, so opening a save never waits on backup I/O. Slots are
+// looked up on the worker from the snapshot passed with each request.
+class BackupQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BackupQueue(QObject *parent = nullptr);
+    ~BackupQueue() override;
+
+    // Skipped while a backup of sourcePath is still waiting to start; the
+    // worker also skips a file whose modification time it already backed up.
+    void requestBackup(const BackupManager &manager, const QString &sourcePath,
+                       const QList<SaveSlot> &slots, const QString &reason);
+    // Backs up the current targetPath, if any, then restores entry over it.
+    void requestRestore(const BackupManager &manager, const BackupEntry &entry,
+                        const QString &targetPath, const QList<SaveSlot> &slots);
+
+    // Writes entry's save bytes to targetPath without touching any live save.
+    void requestExtract(const BackupManager &manager, const BackupEntry &entry, const QString &targetPath);
+
+    // Regenerates the backup index from the sidecars on disk.
+    void requestRescan(const BackupManager &manager);
+    // Applies policy over the catalog; see BackupManager::pruneBackups.
+    void requestPrune(const BackupManager &manager, const RetentionPolicy &policy, bool dryRun);
+    // Removes the backups a dry run listed; also reports through pruneFinished.
+    void requestRemove(const BackupManager &manager, const QList<BackupEntry> &confirmed);
+
+    bool isIdle() const;
+    // Blocks until every queued job has run.
+    void drain();
+
+signals:
+    void backupCreated(const BackupEntry &entry);
+    void backupFailed(const QString &sourcePath, const QString &error);
+    void restoreFinished(const QString &targetPath, bool ok, const QString &error);
+    void extractFinished(const BackupEntry &entry, const QString &targetPath, bool ok, const QString &error);
+    void rescanFinished(bool ok, const QString &error);
+    void pruneFinished(const RetentionReport &report);
+
+private:
+    void finishJob();
+
+    QThreadPool pool_;
+    int pendingJobs_ = 0;
+    QMutex mutex_;
+    QSet<QString> waiting_;
+    QHash<QString, qint64> backedUpMtime_;
+};
@@ -0,0 +1,68 @@
+#include "core/BackupRetention.h"
+
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+constexpr qint64 kMsPerHour = 60LL * 60 * 1000;
+constexpr qint64 kMsPerDay = 24 * kMsPerHour;
+
+QString slotKey(const BackupEntry &entry)
+{
+    if (entry.profileId.isEmpty() && entry.slotId.isEmpty()) {
+        return entry.sourcePath;
+    }
+    return entry.profileId + QLatin1Char('/') + entry.slotId;
+}
+}
+
+QList<BackupEntry> BackupRetention::selectExpired(const QList<BackupEntry> &entries,
+                                                  const RetentionPolicy &policy, qint64 nowMs)
+{
+    QHash<QString, QList<int>> bySlot;
+    for (int i = 0; i < entries.size(); ++i) {
+        bySlot[slotKey(entries.at(i))].append(i);
+    }
+
+    QList<BackupEntry> expired;
+    for (auto it = bySlot.begin(); it != bySlot.end(); ++it) {
+        QList<int> &indices = it.value();
+        std::sort(indices.begin(), indices.end(), [&entries](int a, int b) {
+            return entries.at(a).backupTimeMs > entries.at(b).backupTimeMs;
+        });
+
+        // Walking newest first, a backup in an hour or day that already has
+        // a kept backup is redundant within the thinned tiers.
+        QSet<qint64> keptHours;
+        QSet<qint64> keptDays;
+        int kept = 0;
+        for (int index : indices) {
+            const BackupEntry &entry = entries.at(index);
+            const qint64 age = nowMs - entry.backupTimeMs;
+            const qint64 hour = entry.backupTimeMs / kMsPerHour;
+            const qint64 day = entry.backupTimeMs / kMsPerDay;
+            bool keep = false;
+            if (kept < policy.minPerSlot) {
+                keep = true;
+            } else if (policy.maxPerSlot > 0 && kept >= policy.maxPerSlot) {
+                keep = false;
+            } else if (age < policy.keepAllMs) {
+                keep = true;
+            } else if (age < policy.hourlyMs) {
+                keep = !keptHours.contains(hour);
+            } else if (age < policy.dailyMs) {
+                keep = !keptDays.contains(day);
+            }
+
+            if (keep) {
+                ++kept;
+                keptHours.insert(hour);
+                keptDays.insert(day);
+            } else {
+                expired.append(entry);
+            }
+        }
+    }
+    return expired;
+}
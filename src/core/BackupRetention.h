@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+
+#include "core/BackupManager.h"
+
+// Tiers are measured back from now. Everything inside keepAllMs stays, then
+// the newest backup of each hour up to hourlyMs, then the newest of each day
+// up to dailyMs; older backups go. Each slot keeps at most maxPerSlot (0 for
+// no cap) and never fewer than its newest minPerSlot, whatever their age.
+struct RetentionPolicy {
+    qint64 keepAllMs = 24LL * 60 * 60 * 1000;
+    qint64 hourlyMs = 7LL * 24 * 60 * 60 * 1000;
+    qint64 dailyMs = 30LL * 24 * 60 * 60 * 1000;
+    int maxPerSlot = 200;
+    int minPerSlot = 3;
+};
+
+struct RetentionReport {
+    bool dryRun = true;
+    int keptCount = 0;
+    QList<BackupEntry> removed;
+    int removedBlobs = 0;
+    qint64 reclaimedBytes = 0;
+    QString errorMessage;
+};
+
+namespace BackupRetention {
+// The entries the policy drops. Slots are told apart by profile and slot id.
+QList<BackupEntry> selectExpired(const QList<BackupEntry> &entries, const RetentionPolicy &policy,
+                                 qint64 nowMs);
+}
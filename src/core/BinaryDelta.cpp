@@ -0,0 +1,156 @@
+#include "core/BinaryDelta.h"
+
+#include <QHash>
+#include <cstring>
+
+namespace {
+constexpr int kWindow = 32;
+constexpr quint64 kHashPrime = 0x100000001B3ULL;
+constexpr char kOpCopy = 0;
+constexpr char kOpInsert = 1;
+constexpr int kMaxVarintBytes = 10;
+
+void appendVarint(QByteArray *out, quint64 value)
+{
+    while (value >= 0x80) {
+        out->append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out->append(static_cast<char>(value));
+}
+
+bool readVarint(const QByteArray &data, int *offset, quint64 *value)
+{
+    quint64 result = 0;
+    for (int i = 0; i < kMaxVarintBytes && *offset < data.size(); ++i) {
+        const unsigned char byte = static_cast<unsigned char>(data.at((*offset)++));
+        result |= static_cast<quint64>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+quint64 windowHash(const unsigned char *data)
+{
+    quint64 hash = 0;
+    for (int i = 0; i < kWindow; ++i) {
+        hash = hash * kHashPrime + data[i];
+    }
+    return hash;
+}
+
+void appendInsert(QByteArray *out, const unsigned char *data, int size)
+{
+    if (size <= 0) {
+        return;
+    }
+    out->append(kOpInsert);
+    appendVarint(out, static_cast<quint64>(size));
+    out->append(reinterpret_cast<const char *>(data), size);
+}
+
+void appendCopy(QByteArray *out, int offset, int size)
+{
+    out->append(kOpCopy);
+    appendVarint(out, static_cast<quint64>(offset));
+    appendVarint(out, static_cast<quint64>(size));
+}
+}
+
+QByteArray BinaryDelta::compute(const QByteArray &base, const QByteArray &target)
+{
+    QByteArray out;
+    const auto *source = reinterpret_cast<const unsigned char *>(base.constData());
+    const auto *data = reinterpret_cast<const unsigned char *>(target.constData());
+    const int baseSize = base.size();
+    const int targetSize = target.size();
+    if (baseSize < kWindow || targetSize < kWindow) {
+        appendInsert(&out, data, targetSize);
+        return out;
+    }
+
+    // Base is sampled at window-aligned offsets; target is probed at every
+    // offset with a rolling hash, and matches are grown in both directions.
+    QHash<quint64, int> index;
+    index.reserve(baseSize / kWindow + 1);
+    for (int offset = 0; offset + kWindow <= baseSize; offset += kWindow) {
+        const quint64 hash = windowHash(source + offset);
+        if (!index.contains(hash)) {
+            index.insert(hash, offset);
+        }
+    }
+
+    quint64 leadWeight = 1;
+    for (int i = 1; i < kWindow; ++i) {
+        leadWeight *= kHashPrime;
+    }
+
+    int literalStart = 0;
+    int pos = 0;
+    quint64 hash = windowHash(data);
+    while (pos + kWindow <= targetSize) {
+        auto it = index.constFind(hash);
+        if (it != index.constEnd() && memcmp(source + it.value(), data + pos, kWindow) == 0) {
+            int baseOffset = it.value();
+            int start = pos;
+            while (start > literalStart && baseOffset > 0 && data[start - 1] == source[baseOffset - 1]) {
+                --start;
+                --baseOffset;
+            }
+            int length = pos + kWindow - start;
+            while (start + length < targetSize && baseOffset + length < baseSize
+                   && data[start + length] == source[baseOffset + length]) {
+                ++length;
+            }
+            appendInsert(&out, data + literalStart, start - literalStart);
+            appendCopy(&out, baseOffset, length);
+            pos = start + length;
+            literalStart = pos;
+            if (pos + kWindow <= targetSize) {
+                hash = windowHash(data + pos);
+            }
+            continue;
+        }
+        if (pos + kWindow < targetSize) {
+            hash = (hash - data[pos] * leadWeight) * kHashPrime + data[pos + kWindow];
+        }
+        ++pos;
+    }
+    appendInsert(&out, data + literalStart, targetSize - literalStart);
+    return out;
+}
+
+bool BinaryDelta::apply(const QByteArray &base, const QByteArray &delta, QByteArray *target)
+{
+    QByteArray out;
+    out.reserve(base.size());
+    int offset = 0;
+    while (offset < delta.size()) {
+        const char op = delta.at(offset++);
+        quint64 first = 0;
+        if (!readVarint(delta, &offset, &first)) {
+            return false;
+        }
+        if (op == kOpCopy) {
+            quint64 size = 0;
+            if (!readVarint(delta, &offset, &size) || first > static_cast<quint64>(base.size())
+                || size > static_cast<quint64>(base.size()) - first) {
+                return false;
+            }
+            out.append(base.constData() + first, static_cast<int>(size));
+        } else if (op == kOpInsert) {
+            if (first > static_cast<quint64>(delta.size() - offset)) {
+                return false;
+            }
+            out.append(delta.constData() + offset, static_cast<int>(first));
+            offset += static_cast<int>(first);
+        } else {
+            return false;
+        }
+    }
+    *target = out;
+    return true;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QByteArray>
+
+namespace BinaryDelta {
+// Encodes target as copies from base and inserted literals. Runs in time
+// linear in both sizes, so it suits payloads that differ in scattered spots.
+QByteArray compute(const QByteArray &base, const QByteArray &target);
+// Rebuilds target from base and a delta made by compute(). Returns false for
+// a delta that reads outside base or is truncated.
+bool apply(const QByteArray &base, const QByteArray &delta, QByteArray *target);
+}
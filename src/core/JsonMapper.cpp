@@ -8,6 +8,7 @@
 
 namespace {
 QHash<QString, QString> g_mapping;
+QHash<QString, QString> g_reverseMapping;
 bool g_loaded = false;
 }
 
@@ -68,6 +69,14 @@ QString JsonMapper::mapKey(const QString &shortKey)
     return g_mapping.value(shortKey, shortKey);
 }
 
+QString JsonMapper::unmapKey(const QString &longKey)
+{
+    if (!g_loaded) {
+        return longKey;
+    }
+    return g_reverseMapping.value(longKey, longKey);
+}
+
 bool JsonMapper::isLoaded()
 {
     return g_loaded;
@@ -78,14 +87,27 @@ int JsonMapper::size()
     return g_mapping.size();
 }
 
-QHash<QString, QString> JsonMapper::mapping()
+const QHash<QString, QString> &JsonMapper::mapping()
 {
     return g_mapping;
 }
 
+const QHash<QString, QString> &JsonMapper::reverseMapping()
+{
+    return g_reverseMapping;
+}
+
 void JsonMapper::setMapping(const QHash<QString, QString> &map)
 {
+    QHash<QString, QString> reverse;
+    reverse.reserve(map.size());
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        if (!reverse.contains(it.value())) {
+            reverse.insert(it.value(), it.key());
+        }
+    }
     g_mapping = map;
+    g_reverseMapping = reverse;
     g_loaded = true;
     qInfo() << "JsonMapper loaded keys:" << g_mapping.size();
 }
@@ -10,9 +10,13 @@ public:
     static bool loadMapping(const QString &path);
     static bool loadMappingFromJson(const QJsonObject &root);
     static QString mapKey(const QString &shortKey);
+    static QString unmapKey(const QString &longKey);
     static bool isLoaded();
     static int size();
-    static QHash<QString, QString> mapping();
+    // Short key -> readable key. Built once per load and never modified.
+    static const QHash<QString, QString> &mapping();
+    // Readable key -> short key; the first short key wins on duplicates.
+    static const QHash<QString, QString> &reverseMapping();
 
 private:
     static void setMapping(const QHash<QString, QString> &map);
@@ -0,0 +1,81 @@
+#include "core/JsonPath.h"
+
+#include <QHash>
+#include <QMutex>
+
+namespace {
+// Saves reuse a few thousand short keys, so compiled paths share one copy of
+// each key's text and UTF-8 bytes.
+struct InternedKey {
+    QString key;
+    QByteArray utf8;
+};
+
+InternedKey intern(const QString &key)
+{
+    static QMutex mutex;
+    static QHash<QString, InternedKey> table;
+    QMutexLocker locker(&mutex);
+    auto it = table.constFind(key);
+    if (it == table.constEnd()) {
+        it = table.insert(key, InternedKey{key, key.toUtf8()});
+    }
+    return it.value();
+}
+}
+
+JsonPath::JsonPath(const QVariantList &path)
+    : source_(path)
+{
+    segments_.reserve(path.size());
+    for (const QVariant &part : path) {
+        Segment segment;
+        if (part.canConvert<int>()) {
+            segment.index = part.toInt();
+        }
+        if (part.canConvert<QString>()) {
+            InternedKey interned = intern(part.toString());
+            segment.key = interned.key;
+            segment.utf8 = interned.utf8;
+            segment.hasKey = true;
+        }
+        segments_.append(segment);
+    }
+}
+
+QJsonValue JsonPath::resolve(const QJsonValue &root) const
+{
+    QJsonValue current = root;
+    for (const Segment &segment : segments_) {
+        if (segment.index != kNoIndex && current.isArray()) {
+            current = current[segment.index];
+        } else if (segment.hasKey && current.isObject()) {
+            current = current[segment.key];
+        } else {
+            return QJsonValue();
+        }
+    }
+    return current;
+}
+
+const rapidjson::Value *JsonPath::step(const rapidjson::Value &node, const Segment &segment)
+{
+    if (segment.index != kNoIndex && node.IsArray()) {
+        if (segment.index < 0 || segment.index >= static_cast<int>(node.Size())) {
+            return nullptr;
+        }
+        return &node[static_cast<rapidjson::SizeType>(segment.index)];
+    }
+    if (segment.hasKey && node.IsObject()) {
+        const rapidjson::Value name(rapidjson::StringRef(segment.utf8.constData(),
+                                                         static_cast<rapidjson::SizeType>(segment.utf8.size())));
+        auto it = node.FindMember(name);
+        return it == node.MemberEnd() ? nullptr : &it->value;
+    }
+    return nullptr;
+}
+
+rapidjson::Value *JsonPath::step(rapidjson::Value &node, const Segment &segment)
+{
+    return const_cast<rapidjson::Value *>(step(static_cast<const rapidjson::Value &>(node), segment));
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QList>
+#include <QString>
+#include <QVariantList>
+
+#include <rapidjson/document.h>
+
+class LosslessJsonDocument;
+
+// A QVariantList path converted once into interned keys and indices. Lookups
+// in a LosslessJsonDocument remember the node they resolved to until the
+// document's generation changes, so repeated reads are a single compare.
+// The cache is not synchronised; give each thread its own copy.
+class JsonPath
+{
+public:
+    JsonPath() = default;
+    explicit JsonPath(const QVariantList &path);
+
+    bool isEmpty() const { return segments_.isEmpty(); }
+    int size() const { return segments_.size(); }
+    const QVariantList &toVariantList() const { return source_; }
+
+    // Same rules as the Qt-side walks: objects take the segment as a key,
+    // arrays as an index. Missing keys and indices give Undefined.
+    QJsonValue resolve(const QJsonValue &root) const;
+
+    bool operator==(const JsonPath &other) const { return source_ == other.source_; }
+    bool operator!=(const JsonPath &other) const { return source_ != other.source_; }
+
+private:
+    friend class LosslessJsonDocument;
+
+    static constexpr int kNoIndex = -1;
+
+    struct Segment {
+        QString key;
+        QByteArray utf8;
+        int index = kNoIndex;
+        bool hasKey = false;
+    };
+
+    static const rapidjson::Value *step(const rapidjson::Value &node, const Segment &segment);
+    static rapidjson::Value *step(rapidjson::Value &node, const Segment &segment);
+
+    QVariantList source_;
+    QList<Segment> segments_;
+    mutable const rapidjson::Value *cachedNode_ = nullptr;
+    mutable quint64 cachedGeneration_ = 0;
+};
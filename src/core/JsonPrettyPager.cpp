@@ -0,0 +1,136 @@
+#include "core/JsonPrettyPager.h"
+
+#include "core/JsonMapper.h"
+
+#include <QLocale>
+
+namespace {
+constexpr int kIndentWidth = 4;
+
+void appendIndent(QByteArray &out, int depth)
+{
+    out.append('\n');
+    out.append(QByteArray(depth * kIndentWidth, ' '));
+}
+
+void appendQuoted(QByteArray &out, const char *text, rapidjson::SizeType length)
+{
+    static const char kHex[] = "0123456789abcdef";
+    out.append('"');
+    for (rapidjson::SizeType i = 0; i < length; ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        switch (c) {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\b': out.append("\\b"); break;
+        case '\f': out.append("\\f"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            if (c < 0x20) {
+                out.append("\\u00");
+                out.append(kHex[c >> 4]);
+                out.append(kHex[c & 0xF]);
+            } else {
+                out.append(static_cast<char>(c));
+            }
+            break;
+        }
+    }
+    out.append('"');
+}
+
+int childCount(const rapidjson::Value &value)
+{
+    return value.IsObject() ? static_cast<int>(value.MemberCount())
+                            : static_cast<int>(value.Size());
+}
+}
+
+JsonPrettyPager::JsonPrettyPager(const std::shared_ptr<LosslessJsonDocument> &doc,
+                                 const JsonPath &path)
+    : doc_(doc)
+    , path_(path)
+{
+}
+
+void JsonPrettyPager::writeValue(const rapidjson::Value &value, QByteArray &out)
+{
+    if (value.IsObject() || value.IsArray()) {
+        const bool isObject = value.IsObject();
+        out.append(isObject ? '{' : '[');
+        if (childCount(value) == 0) {
+            out.append(isObject ? '}' : ']');
+            return;
+        }
+        stack_.append(Frame{&value, 0});
+        return;
+    }
+    if (value.IsString()) {
+        appendQuoted(out, value.GetString(), value.GetStringLength());
+    } else if (value.IsBool()) {
+        out.append(value.GetBool() ? "true" : "false");
+    } else if (value.IsNull()) {
+        out.append("null");
+    } else if (value.IsInt64()) {
+        out.append(QByteArray::number(value.GetInt64()));
+    } else if (value.IsUint64()) {
+        out.append(QByteArray::number(value.GetUint64()));
+    } else {
+        out.append(QByteArray::number(value.GetDouble(), 'g', QLocale::FloatingPointShortest));
+    }
+}
+
+QByteArray JsonPrettyPager::nextChunk(int maxBytes)
+{
+    QByteArray out;
+    if (!doc_ || atEnd()) {
+        return out;
+    }
+    QReadLocker locker(doc_->lock());
+    if (!started_) {
+        started_ = true;
+        generation_ = doc_->generation();
+        out.reserve(maxBytes + 256);
+        if (const rapidjson::Value *value = doc_->valueAtPath(path_)) {
+            writeValue(*value, out);
+        }
+    } else if (doc_->generation() != generation_) {
+        stale_ = true;
+        stack_.clear();
+        return out;
+    } else {
+        out.reserve(maxBytes + 256);
+    }
+
+    while (!stack_.isEmpty() && out.size() < maxBytes) {
+        Frame &top = stack_.last();
+        const rapidjson::Value &container = *top.value;
+        const bool isObject = container.IsObject();
+        if (top.index >= static_cast<rapidjson::SizeType>(childCount(container))) {
+            appendIndent(out, stack_.size() - 1);
+            out.append(isObject ? '}' : ']');
+            stack_.removeLast();
+            continue;
+        }
+
+        const rapidjson::SizeType index = top.index++;
+        if (index > 0) {
+            out.append(',');
+        }
+        appendIndent(out, stack_.size());
+        if (isObject) {
+            const auto member = container.MemberBegin() + index;
+            QString key = QString::fromUtf8(member->name.GetString(),
+                                            static_cast<int>(member->name.GetStringLength()));
+            QByteArray mapped = JsonMapper::mapKey(key).toUtf8();
+            appendQuoted(out, mapped.constData(), static_cast<rapidjson::SizeType>(mapped.size()));
+            out.append(": ");
+            writeValue(member->value, out);
+        } else {
+            writeValue(container[index], out);
+        }
+    }
+    return out;
+}
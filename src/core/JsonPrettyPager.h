@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <memory>
+
+#include "core/LosslessJsonDocument.h"
+
+// Pretty-prints the lossless value at a path with mapped key names a page at a
+// time, so a viewer only pays for the text that is actually shown. Each chunk
+// is read under the document's read lock; once the document is edited the
+// pager goes stale, since the nodes it was walking may have moved.
+class JsonPrettyPager
+{
+public:
+    JsonPrettyPager(const std::shared_ptr<LosslessJsonDocument> &doc, const JsonPath &path);
+
+    const JsonPath &path() const { return path_; }
+    bool atEnd() const { return stale_ || (started_ && stack_.isEmpty()); }
+    bool isStale() const { return stale_; }
+    // Returns at least one token and stops at the first token boundary past
+    // maxBytes. Returns nothing once stale.
+    QByteArray nextChunk(int maxBytes);
+
+private:
+    struct Frame {
+        const rapidjson::Value *value = nullptr;
+        rapidjson::SizeType index = 0;
+    };
+
+    void writeValue(const rapidjson::Value &value, QByteArray &out);
+
+    std::shared_ptr<LosslessJsonDocument> doc_;
+    JsonPath path_;
+    quint64 generation_ = 0;
+    QList<Frame> stack_;
+    bool started_ = false;
+    bool stale_ = false;
+};
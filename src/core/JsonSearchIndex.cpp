@@ -0,0 +1,234 @@
+#include "core/JsonSearchIndex.h"
+
+#include "core/JsonMapper.h"
+
+#include <QStringMatcher>
+
+namespace {
+constexpr int kNodesPerLock = 4096;
+constexpr int kYieldingWalks = 3;
+
+QString entryText(const rapidjson::Value &value, int parent, int row, const QString &key)
+{
+    QString text;
+    if (!key.isEmpty()) {
+        const QString mapped = JsonMapper::mapKey(key);
+        text = mapped;
+        if (mapped != key) {
+            text += QLatin1Char('\n') + key;
+        }
+    } else if (parent >= 0) {
+        text = QStringLiteral("[%1]").arg(row);
+    }
+    if (value.IsString()) {
+        text += QLatin1Char('\n');
+        text += QString::fromUtf8(value.GetString(), static_cast<int>(value.GetStringLength()));
+    }
+    return text.toLower();
+}
+}
+
+std::shared_ptr<JsonSearchIndex> JsonSearchIndex::build(const std::shared_ptr<LosslessJsonDocument> &doc)
+{
+    auto index = std::make_shared<JsonSearchIndex>();
+    if (!doc) {
+        return index;
+    }
+    // A steady stream of edits could restart a yielding walk forever, so after
+    // kYieldingWalks attempts the last one holds the lock to the end.
+    for (int attempt = 0; attempt < kYieldingWalks; ++attempt) {
+        if (index->walk(*doc, true)) {
+            return index;
+        }
+    }
+    index->walk(*doc, false);
+    return index;
+}
+
+// Walks with an explicit stack so that, with yieldLock, the read lock can be
+// given up every kNodesPerLock nodes; edits on the UI thread then never wait
+// out a whole walk. Returns false when an edit landed in between and the walk
+// must start over, since the stacked node pointers may no longer be valid.
+bool JsonSearchIndex::walk(const LosslessJsonDocument &doc, bool yieldLock)
+{
+    struct Frame {
+        const rapidjson::Value *value;
+        int self;
+        rapidjson::SizeType next;
+    };
+
+    entries_.clear();
+    QReadLocker locker(doc.lock());
+    generation_ = doc.generation();
+    QList<Frame> stack;
+    auto append = [this, &stack](const rapidjson::Value &value, int parent, int row, const QString &key) {
+        Entry entry;
+        entry.parent = parent;
+        entry.row = row;
+        entry.key = key;
+        entry.text = entryText(value, parent, row, key);
+        const int self = static_cast<int>(entries_.size());
+        entry.end = self + 1;
+        entries_.append(entry);
+        if (value.IsObject() || value.IsArray()) {
+            stack.append(Frame{&value, self, 0});
+        }
+    };
+
+    append(doc.root(), -1, 0, QString());
+    int budget = kNodesPerLock;
+    while (!stack.isEmpty()) {
+        const Frame frame = stack.last();
+        const rapidjson::Value &value = *frame.value;
+        const rapidjson::SizeType count = value.IsObject() ? value.MemberCount() : value.Size();
+        if (frame.next >= count) {
+            entries_[frame.self].end = static_cast<int>(entries_.size());
+            stack.removeLast();
+            continue;
+        }
+        ++stack.last().next;
+        const int row = static_cast<int>(frame.next);
+        if (value.IsObject()) {
+            const auto member = value.MemberBegin() + frame.next;
+            append(member->value, frame.self, row,
+                   QString::fromUtf8(member->name.GetString(),
+                                     static_cast<int>(member->name.GetStringLength())));
+        } else {
+            append(value[frame.next], frame.self, row, QString());
+        }
+
+        if (yieldLock && --budget == 0) {
+            budget = kNodesPerLock;
+            locker.unlock();
+            locker.relock();
+            if (doc.generation() != generation_) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void JsonSearchIndex::appendValue(const rapidjson::Value &value, int parent, int row,
+                                  const QString &key, QList<Entry> &out)
+{
+    const int self = out.size();
+    Entry entry;
+    entry.parent = parent;
+    entry.row = row;
+    entry.key = key;
+    entry.text = entryText(value, parent, row, key);
+    out.append(entry);
+
+    if (value.IsObject()) {
+        int childRow = 0;
+        for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it, ++childRow) {
+            QString childKey = QString::fromUtf8(it->name.GetString(),
+                                                 static_cast<int>(it->name.GetStringLength()));
+            appendValue(it->value, self, childRow, childKey, out);
+        }
+    } else if (value.IsArray()) {
+        for (rapidjson::SizeType i = 0; i < value.Size(); ++i) {
+            appendValue(value[i], self, static_cast<int>(i), QString(), out);
+        }
+    }
+    out[self].end = out.size();
+}
+
+bool JsonSearchIndex::update(const LosslessJsonDocument &doc, const QVariantList &path)
+{
+    const int first = entryForPath(path);
+    const rapidjson::Value *value = doc.valueAtPath(path);
+    if (first < 0 || !value) {
+        return false;
+    }
+    generation_ = doc.generation();
+
+    const int parent = entries_.at(first).parent;
+    const int oldEnd = entries_.at(first).end;
+    QList<Entry> replacement;
+    appendValue(*value, parent, entries_.at(first).row, entries_.at(first).key, replacement);
+    // appendValue numbers nested parents from zero; rebase them onto first.
+    for (int i = 1; i < replacement.size(); ++i) {
+        replacement[i].parent += first;
+    }
+    for (Entry &entry : replacement) {
+        entry.end += first;
+    }
+
+    const int delta = replacement.size() - (oldEnd - first);
+    if (delta == 0) {
+        for (int i = 0; i < replacement.size(); ++i) {
+            entries_[first + i] = replacement.at(i);
+        }
+        return true;
+    }
+
+    for (int ancestor = parent; ancestor >= 0; ancestor = entries_.at(ancestor).parent) {
+        entries_[ancestor].end += delta;
+    }
+    QList<Entry> tail = entries_.mid(oldEnd);
+    for (Entry &entry : tail) {
+        if (entry.parent >= oldEnd) {
+            entry.parent += delta;
+        }
+        entry.end += delta;
+    }
+    entries_.resize(first);
+    entries_ += replacement;
+    entries_ += tail;
+    return true;
+}
+
+QList<int> JsonSearchIndex::find(const QString &needle) const
+{
+    QList<int> hits;
+    if (needle.isEmpty()) {
+        return hits;
+    }
+    const QStringMatcher matcher(needle, Qt::CaseSensitive);
+    for (int i = 0; i < entries_.size(); ++i) {
+        if (matcher.indexIn(entries_.at(i).text) >= 0) {
+            hits.append(i);
+        }
+    }
+    return hits;
+}
+
+QVariantList JsonSearchIndex::pathAt(int entry) const
+{
+    QVariantList path;
+    for (int i = entry; i > 0 && i < entries_.size(); i = entries_.at(i).parent) {
+        const Entry &current = entries_.at(i);
+        if (current.key.isEmpty()) {
+            path.prepend(current.row);
+        } else {
+            path.prepend(current.key);
+        }
+    }
+    return path;
+}
+
+int JsonSearchIndex::entryForPath(const QVariantList &path) const
+{
+    if (entries_.isEmpty()) {
+        return -1;
+    }
+    int current = 0;
+    for (const QVariant &segment : path) {
+        const int end = entries_.at(current).end;
+        int child = current + 1;
+        while (child < end) {
+            const Entry &entry = entries_.at(child);
+            if (entry.key.isEmpty() ? entry.row == segment.toInt() : entry.key == segment.toString()) {
+                break;
+            }
+            child = entry.end;
+        }
+        if (child >= end) {
+            return -1;
+        }
+        current = child;
+    }
+    return current;
+}
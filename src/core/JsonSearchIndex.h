@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QVariantList>
+#include <memory>
+
+#include "core/LosslessJsonDocument.h"
+
+// Flat pre-order index of a lossless document's mapped keys, short keys and
+// string values. Built once per load off the UI thread and patched per edit.
+// generation() is the document generation the index matches.
+class JsonSearchIndex
+{
+public:
+    static std::shared_ptr<JsonSearchIndex> build(const std::shared_ptr<LosslessJsonDocument> &doc);
+
+    // Re-indexes the subtree at path after it was replaced in place.
+    bool update(const LosslessJsonDocument &doc, const QVariantList &path);
+
+    // Entry ordinals in document order whose text contains needle (lowercase).
+    QList<int> find(const QString &needle) const;
+    QVariantList pathAt(int entry) const;
+    int entryForPath(const QVariantList &path) const;
+    int size() const { return entries_.size(); }
+    quint64 generation() const { return generation_; }
+
+private:
+    struct Entry {
+        int parent = -1;
+        int end = 0;
+        int row = 0;
+        QString key;
+        QString text;
+    };
+
+    bool walk(const LosslessJsonDocument &doc, bool yieldLock);
+    static void appendValue(const rapidjson::Value &value, int parent, int row,
+                            const QString &key, QList<Entry> &out);
+
+    QList<Entry> entries_;
+    quint64 generation_ = 0;
+};
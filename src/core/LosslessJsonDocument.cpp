@@ -1,6 +1,8 @@
 #include "core/LosslessJsonDocument.h"
 
+#include <atomic>
 #include <cmath>
+#include <cstring>
 #include <limits>
 
 #include <QJsonArray>
@@ -105,18 +107,104 @@ rapidjson::Value toRapidValue(const QJsonValue &value, rapidjson::Document::Allo
     out.SetNull();
     return out;
 }
+
+quint64 mixHash(quint64 seed, quint64 value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+quint64 hashBytes(const char *data, qsizetype length)
+{
+    return static_cast<quint64>(qHashBits(data, static_cast<size_t>(length), 0));
+}
+
+quint64 hashInteger(qint64 value)
+{
+    return mixHash(5, static_cast<quint64>(value));
+}
+
+// Integral doubles hash like integers so 5 and 5.0 agree across both sides.
+quint64 hashDouble(double value)
+{
+    if (std::trunc(value) == value && value >= -9223372036854775808.0 && value < 9223372036854775808.0) {
+        return hashInteger(static_cast<qint64>(value));
+    }
+    quint64 bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return mixHash(7, bits);
+}
+
+quint64 hashString(const char *data, qsizetype length)
+{
+    return mixHash(4, hashBytes(data, length));
+}
+
+quint64 hashRapidValue(const rapidjson::Value &value, QHash<const rapidjson::Value *, quint64> &cache)
+{
+    switch (value.GetType()) {
+    case rapidjson::kNullType:
+        return 1;
+    case rapidjson::kFalseType:
+        return 2;
+    case rapidjson::kTrueType:
+        return 3;
+    case rapidjson::kStringType:
+        return hashString(value.GetString(), static_cast<qsizetype>(value.GetStringLength()));
+    case rapidjson::kNumberType:
+        if (value.IsInt64()) {
+            return hashInteger(value.GetInt64());
+        }
+        if (value.IsUint64()) {
+            return mixHash(6, value.GetUint64());
+        }
+        return hashDouble(value.GetDouble());
+    case rapidjson::kObjectType:
+    case rapidjson::kArrayType:
+        break;
+    }
+
+    auto cached = cache.constFind(&value);
+    if (cached != cache.constEnd()) {
+        return cached.value();
+    }
+    quint64 hash = 0;
+    if (value.IsObject()) {
+        quint64 members = 0;
+        for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
+            const quint64 key = hashBytes(it->name.GetString(), static_cast<qsizetype>(it->name.GetStringLength()));
+            members += mixHash(key, hashRapidValue(it->value, cache));
+        }
+        hash = mixHash(mixHash(8, value.MemberCount()), members);
+    } else {
+        hash = mixHash(9, value.Size());
+        for (const rapidjson::Value &element : value.GetArray()) {
+            hash = mixHash(hash, hashRapidValue(element, cache));
+        }
+    }
+    cache.insert(&value, hash);
+    return hash;
+}
 }
 
-bool LosslessJsonDocument::parse(const QByteArray &json, QString *errorMessage)
+bool LosslessJsonDocument::parse(QByteArray json, QString *errorMessage)
 {
-    doc_.Parse<rapidjson::kParseFullPrecisionFlag>(json.constData());
-    if (doc_.HasParseError()) {
+    // In-situ parsing rewrites escapes in place; data() detaches json first
+    // if anyone else still holds it.
+    rapidjson::Document doc;
+    doc.ParseInsitu<rapidjson::kParseFullPrecisionFlag>(json.data());
+    if (doc.HasParseError()) {
         if (errorMessage) {
             *errorMessage = QStringLiteral("RapidJSON parse error at offset %1")
-                                .arg(doc_.GetErrorOffset());
+                                .arg(doc.GetErrorOffset());
         }
         return false;
     }
+    doc_.Swap(doc);
+    buffer_ = std::move(json);
+    generation_ = nextGeneration();
+    edits_.clear();
+    QMutexLocker hashLocker(&hashMutex_);
+    hashCache_.clear();
     return true;
 }
 
@@ -134,65 +222,241 @@ QByteArray LosslessJsonDocument::toJson(bool pretty) const
 }
 
 bool LosslessJsonDocument::setValueAtPath(const QVariantList &path, const QJsonValue &value)
+{
+    return setValueAtPath(JsonPath(path), value);
+}
+
+bool LosslessJsonDocument::setValueAtPath(const JsonPath &path, const QJsonValue &value)
 {
     if (path.isEmpty()) {
         return false;
     }
 
+    QWriteLocker locker(&lock_);
+    // Replacing a value or growing an object can move nodes, so every cached
+    // resolution of this document is dropped.
+    generation_ = nextGeneration();
+
+    // Every container on the path changes content, so drop their cached hashes.
+    QMutexLocker hashLocker(&hashMutex_);
     rapidjson::Value *node = &doc_;
+    hashCache_.remove(node);
     for (int i = 0; i < path.size() - 1; ++i) {
-        const QVariant &segment = path.at(i);
-        if (segment.canConvert<int>() && node->IsArray()) {
-            int index = segment.toInt();
-            if (index < 0 || index >= static_cast<int>(node->Size())) {
-                return false;
-            }
-            node = &(*node)[static_cast<rapidjson::SizeType>(index)];
-            continue;
-        }
-        if (segment.canConvert<QString>() && node->IsObject()) {
-            QByteArray key = segment.toString().toUtf8();
-            if (!node->HasMember(key.constData())) {
-                return false;
-            }
-            node = &(*node)[key.constData()];
-            continue;
+        node = JsonPath::step(*node, path.segments_.at(i));
+        if (!node) {
+            return false;
         }
-        return false;
+        hashCache_.remove(node);
     }
 
     rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
-    const QVariant &leaf = path.last();
-    if (leaf.canConvert<int>() && node->IsArray()) {
-        int index = leaf.toInt();
-        if (index < 0 || index >= static_cast<int>(node->Size())) {
+    const JsonPath::Segment &leaf = path.segments_.last();
+    if (leaf.index != JsonPath::kNoIndex && node->IsArray()) {
+        rapidjson::Value *existing = JsonPath::step(*node, leaf);
+        if (!existing) {
             return false;
         }
-        rapidjson::Value &existing = (*node)[static_cast<rapidjson::SizeType>(index)];
-        rapidjson::Value newValue = toRapidNumberForExisting(value, existing, alloc);
-        existing = newValue;
+        rapidjson::Value newValue = toRapidNumberForExisting(value, *existing, alloc);
+        replaceValue(path, *existing, newValue);
         return true;
     }
-    if (leaf.canConvert<QString>() && node->IsObject()) {
-        QByteArray key = leaf.toString().toUtf8();
-        if (node->HasMember(key.constData())) {
-            rapidjson::Value &existing = (*node)[key.constData()];
-            rapidjson::Value newValue = toRapidNumberForExisting(value, existing, alloc);
-            existing = newValue;
+    if (leaf.hasKey && node->IsObject()) {
+        if (rapidjson::Value *existing = JsonPath::step(*node, leaf)) {
+            rapidjson::Value newValue = toRapidNumberForExisting(value, *existing, alloc);
+            replaceValue(path, *existing, newValue);
         } else {
             rapidjson::Value newValue = toRapidValue(value, alloc);
             rapidjson::Value keyValue;
-            keyValue.SetString(key.constData(), static_cast<rapidjson::SizeType>(key.size()), alloc);
+            keyValue.SetString(leaf.utf8.constData(), static_cast<rapidjson::SizeType>(leaf.utf8.size()), alloc);
             node->AddMember(keyValue, newValue, alloc);
+            if (recordingEdits_) {
+                edits_.append(Edit{path.toVariantList(), nullptr});
+            }
         }
         return true;
     }
     return false;
 }
 
+void LosslessJsonDocument::replaceValue(const JsonPath &path, rapidjson::Value &existing,
+                                        rapidjson::Value &newValue)
+{
+    hashCache_.remove(&existing);
+    if (!recordingEdits_) {
+        existing = newValue;
+        return;
+    }
+    // The old subtree stays in the pool either way; keeping its root is all
+    // undo needs.
+    auto displaced = std::make_shared<rapidjson::Value>();
+    displaced->Swap(existing);
+    existing = newValue;
+    edits_.append(Edit{path.toVariantList(), displaced});
+}
+
+void LosslessJsonDocument::setRecordingEdits(bool recording)
+{
+    QWriteLocker locker(&lock_);
+    recordingEdits_ = recording;
+    if (!recording) {
+        edits_.clear();
+    }
+}
+
+QList<LosslessJsonDocument::Edit> LosslessJsonDocument::takeEdits()
+{
+    QWriteLocker locker(&lock_);
+    QList<Edit> edits;
+    edits.swap(edits_);
+    return edits;
+}
+
+bool LosslessJsonDocument::applyEdit(Edit &edit)
+{
+    const JsonPath path(edit.path);
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    QWriteLocker locker(&lock_);
+    generation_ = nextGeneration();
+    QMutexLocker hashLocker(&hashMutex_);
+    rapidjson::Value *node = &doc_;
+    hashCache_.remove(node);
+    for (int i = 0; i < path.size() - 1; ++i) {
+        node = JsonPath::step(*node, path.segments_.at(i));
+        if (!node) {
+            return false;
+        }
+        hashCache_.remove(node);
+    }
+
+    const JsonPath::Segment &leaf = path.segments_.last();
+    rapidjson::Value *target = JsonPath::step(*node, leaf);
+    if (target && edit.value) {
+        hashCache_.remove(target);
+        target->Swap(*edit.value);
+        return true;
+    }
+    if (!leaf.hasKey || !node->IsObject()) {
+        return false;
+    }
+    if (target) {
+        const rapidjson::Value name(rapidjson::StringRef(leaf.utf8.constData(),
+                                                         static_cast<rapidjson::SizeType>(leaf.utf8.size())));
+        auto member = node->FindMember(name);
+        // Erasing shifts the later members down onto addresses the hash cache
+        // knows under other contents.
+        for (auto it = member; it != node->MemberEnd(); ++it) {
+            hashCache_.remove(&it->value);
+        }
+        edit.value = std::make_shared<rapidjson::Value>();
+        edit.value->Swap(member->value);
+        node->EraseMember(member);
+        return true;
+    }
+    if (!edit.value) {
+        return false;
+    }
+    rapidjson::Value keyValue;
+    keyValue.SetString(leaf.utf8.constData(), static_cast<rapidjson::SizeType>(leaf.utf8.size()),
+                       doc_.GetAllocator());
+    node->AddMember(keyValue, *edit.value, doc_.GetAllocator());
+    edit.value.reset();
+    return true;
+}
+
+const rapidjson::Value *LosslessJsonDocument::valueAtPath(const QVariantList &path) const
+{
+    return valueAtPath(JsonPath(path));
+}
+
+const rapidjson::Value *LosslessJsonDocument::valueAtPath(const JsonPath &path) const
+{
+    if (path.cachedNode_ && path.cachedGeneration_ == generation_) {
+        return path.cachedNode_;
+    }
+    const rapidjson::Value *node = &doc_;
+    for (const JsonPath::Segment &segment : path.segments_) {
+        node = JsonPath::step(*node, segment);
+        if (!node) {
+            return nullptr;
+        }
+    }
+    path.cachedNode_ = node;
+    path.cachedGeneration_ = generation_;
+    return node;
+}
+
 std::shared_ptr<LosslessJsonDocument> LosslessJsonDocument::clone() const
 {
     auto copy = std::make_shared<LosslessJsonDocument>();
+    // Strings still owned by buffer_ are shared with the copy rather than duplicated.
+    copy->buffer_ = buffer_;
     copy->doc_.CopyFrom(doc_, copy->doc_.GetAllocator());
     return copy;
 }
+
+quint64 LosslessJsonDocument::nextGeneration()
+{
+    static std::atomic<quint64> counter{0};
+    return ++counter;
+}
+
+quint64 LosslessJsonDocument::hash(const rapidjson::Value &value) const
+{
+    QMutexLocker locker(&hashMutex_);
+    return hashRapidValue(value, hashCache_);
+}
+
+bool LosslessJsonDocument::hashAtPath(const QVariantList &path, quint64 *hash) const
+{
+    const rapidjson::Value *node = valueAtPath(path);
+    if (!node) {
+        return false;
+    }
+    if (hash) {
+        *hash = this->hash(*node);
+    }
+    return true;
+}
+
+quint64 LosslessJsonDocument::hashValue(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        return value.toBool() ? 3 : 2;
+    case QJsonValue::Double: {
+        const qint64 integer = value.toInteger(std::numeric_limits<qint64>::min());
+        if (integer != std::numeric_limits<qint64>::min()) {
+            return hashInteger(integer);
+        }
+        return hashDouble(value.toDouble());
+    }
+    case QJsonValue::String: {
+        const QByteArray utf8 = value.toString().toUtf8();
+        return hashString(utf8.constData(), utf8.size());
+    }
+    case QJsonValue::Array: {
+        const QJsonArray array = value.toArray();
+        quint64 hash = mixHash(9, static_cast<quint64>(array.size()));
+        for (const QJsonValue &element : array) {
+            hash = mixHash(hash, hashValue(element));
+        }
+        return hash;
+    }
+    case QJsonValue::Object: {
+        const QJsonObject object = value.toObject();
+        quint64 members = 0;
+        for (auto it = object.begin(); it != object.end(); ++it) {
+            const QByteArray key = it.key().toUtf8();
+            members += mixHash(hashBytes(key.constData(), key.size()), hashValue(it.value()));
+        }
+        return mixHash(mixHash(8, static_cast<quint64>(object.size())), members);
+    }
+    case QJsonValue::Null:
+    case QJsonValue::Undefined:
+        break;
+    }
+    return 1;
+}
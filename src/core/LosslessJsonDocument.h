@@ -2,25 +2,78 @@
 
 #include <QByteArray>
 #include <QJsonValue>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QReadWriteLock>
 #include <QString>
 #include <QVariantList>
 #include <memory>
 
 #include <rapidjson/document.h>
 
+#include "core/JsonPath.h"
+
 class LosslessJsonDocument
 {
 public:
-    bool parse(const QByteArray &json, QString *errorMessage = nullptr);
+    // One setValueAtPath recorded for undo. Applying it swaps the node at path
+    // with value, adding or removing the member when value or the node is
+    // absent, so applying it again reverses it. The value lives in this
+    // document's allocator and must not outlive the document.
+    struct Edit {
+        QVariantList path;
+        std::shared_ptr<rapidjson::Value> value;
+    };
+
+    // Parses in situ and keeps json as the backing store, so strings point into
+    // it instead of being copied into the allocator. json is only copied when
+    // the caller still shares it.
+    bool parse(QByteArray json, QString *errorMessage = nullptr);
     QByteArray toJson(bool pretty = false) const;
     bool setValueAtPath(const QVariantList &path, const QJsonValue &value);
+    bool setValueAtPath(const JsonPath &path, const QJsonValue &value);
+    const rapidjson::Value *valueAtPath(const QVariantList &path) const;
+    const rapidjson::Value *valueAtPath(const JsonPath &path) const;
     std::shared_ptr<LosslessJsonDocument> clone() const;
 
+    // While recording, setValueAtPath keeps the values it replaces instead of
+    // discarding them; takeEdits hands them over in write order.
+    void setRecordingEdits(bool recording);
+    QList<Edit> takeEdits();
+    bool applyEdit(Edit &edit);
+
+    // Content hash of a subtree of this document. Container hashes are cached
+    // and dropped along the edited path by setValueAtPath. Object hashes ignore
+    // member order and numbers hash by value, so they match hashValue() of the
+    // equivalent QJsonValue.
+    quint64 hash(const rapidjson::Value &value) const;
+    bool hashAtPath(const QVariantList &path, quint64 *hash) const;
+    static quint64 hashValue(const QJsonValue &value);
+
     bool isNull() const { return doc_.IsNull(); }
+    // Size of the JSON text the document was parsed from.
+    qint64 sourceSize() const { return buffer_.size(); }
     bool isArray() const { return doc_.IsArray(); }
     bool isObject() const { return doc_.IsObject(); }
     const rapidjson::Value &root() const { return doc_; }
+    // Changes on every parse and edit and is never reused by another document,
+    // so it can key caches of node pointers.
+    quint64 generation() const { return generation_; }
+    // Edits take this for writing; readers off the UI thread hold it for reading.
+    QReadWriteLock *lock() const { return &lock_; }
 
 private:
+    static quint64 nextGeneration();
+    void replaceValue(const JsonPath &path, rapidjson::Value &existing, rapidjson::Value &newValue);
+
+    // Backing store for in-situ strings; shared read-only with clones.
+    QByteArray buffer_;
     rapidjson::Document doc_;
+    quint64 generation_ = nextGeneration();
+    bool recordingEdits_ = false;
+    QList<Edit> edits_;
+    mutable QReadWriteLock lock_;
+    mutable QMutex hashMutex_;
+    mutable QHash<const rapidjson::Value *, quint64> hashCache_;
 };
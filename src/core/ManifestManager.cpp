@@ -158,7 +158,9 @@ ManifestData ManifestManager::readManifest(const QString &path, int slotIndex) {
     return data;
 }
 
-bool ManifestManager::writeManifest(const QString &path, int slotIndex, const QByteArray &saveBytes, const ManifestData &baseData) {
+bool ManifestManager::buildManifest(const QString &path, int slotIndex, const QByteArray &saveBytes,
+                                    const QByteArray &saveSha256, const ManifestData &baseData,
+                                    QByteArray *manifestBytes) {
     QFile file(path);
     if (!file.open(QIODevice::ReadOnly)) return false;
     QByteArray bytes = file.readAll();
@@ -174,8 +176,8 @@ bool ManifestManager::writeManifest(const QString &path, int slotIndex, const QB
 
     if (words[0] != 0xEEEEEEBE) return false;
 
-    // Calculate new SHA256
-    QByteArray newSha = QCryptographicHash::hash(saveBytes, QCryptographicHash::Sha256);
+    const QByteArray &newSha = saveSha256;
+    if (newSha.size() != 32) return false;
     std::memcpy(&words[6], newSha.constData(), 32);
 
     // Calculate new SpookyHash V2
@@ -196,10 +198,7 @@ bool ManifestManager::writeManifest(const QString &path, int slotIndex, const QB
 
     XXTEA::encrypt(words, bytes.size() / 4, key);
 
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
-    file.write(bytes);
-    file.close();
-
+    *manifestBytes = bytes;
     return true;
 }
 
@@ -18,7 +18,11 @@ struct ManifestData {
 class ManifestManager {
 public:
     static ManifestData readManifest(const QString &path, int slotIndex);
-    static bool writeManifest(const QString &path, int slotIndex, const QByteArray &saveBytes, const ManifestData &baseData);
+    // Produces the updated, re-encrypted manifest without touching the file so
+    // callers can stage it alongside the save it describes.
+    static bool buildManifest(const QString &path, int slotIndex, const QByteArray &saveBytes,
+                              const QByteArray &saveSha256, const ManifestData &baseData,
+                              QByteArray *manifestBytes);
     static void logManifestValidation(const QString &path, int slotIndex, const QByteArray &saveBytes);
 
 private:
@@ -4,6 +4,7 @@
 #include <QFileInfo>
 #include <QDebug>
 #include <QJsonParseError>
+#include <QList>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QObject>
@@ -13,17 +14,31 @@
 #include "core/LosslessJsonDocument.h"
 
 namespace {
-struct SaveCacheEntry {
+const int kDefaultMaxEntries = 4;
+const qint64 kDefaultByteBudget = qint64(1024) * 1024 * 1024;
+// Rough in-memory expansion of the parsed trees relative to the decoded JSON.
+const int kQtDocCostFactor = 3;
+const int kLosslessCostFactor = 2;
+
+struct SaveCacheKey {
     QString canonicalPath;
     qint64 mtime = 0;
     qint64 size = 0;
+};
+
+struct SaveCacheEntry {
+    SaveCacheKey key;
+    // Dropped once the lossless document exists, which keeps the same text.
     QByteArray bytes;
+    qint64 jsonSize = 0;
     QJsonDocument doc;
     std::shared_ptr<LosslessJsonDocument> lossless;
-    bool valid = false;
 };
 
-SaveCacheEntry g_cache;
+// Most recently used entry first.
+QList<SaveCacheEntry> g_entries;
+int g_maxEntries = kDefaultMaxEntries;
+qint64 g_byteBudget = kDefaultByteBudget;
 QMutex g_cacheMutex;
 
 QString canonicalizePath(const QString &filePath, QFileInfo &info)
@@ -31,6 +46,72 @@ QString canonicalizePath(const QString &filePath, QFileInfo &info)
     const QString canonical = info.canonicalFilePath();
     return canonical.isEmpty() ? info.absoluteFilePath() : canonical;
 }
+
+SaveCacheKey keyForFile(const QString &filePath, QFileInfo &info)
+{
+    SaveCacheKey key;
+    key.canonicalPath = canonicalizePath(filePath, info);
+    key.mtime = info.lastModified().toMSecsSinceEpoch();
+    key.size = info.size();
+    return key;
+}
+
+bool sameKey(const SaveCacheKey &a, const SaveCacheKey &b)
+{
+    return a.canonicalPath == b.canonicalPath && a.mtime == b.mtime && a.size == b.size;
+}
+
+qint64 entryCost(const SaveCacheEntry &entry)
+{
+    qint64 cost = entry.jsonSize;
+    if (!entry.doc.isNull()) {
+        cost += entry.jsonSize * kQtDocCostFactor;
+    }
+    if (entry.lossless) {
+        cost += entry.jsonSize * kLosslessCostFactor;
+    }
+    return cost;
+}
+
+void evictLocked()
+{
+    qint64 total = 0;
+    for (const SaveCacheEntry &entry : g_entries) {
+        total += entryCost(entry);
+    }
+    // The most recent entry always stays, even when it alone exceeds the budget.
+    while (g_entries.size() > 1
+           && (g_entries.size() > g_maxEntries || total > g_byteBudget)) {
+        total -= entryCost(g_entries.last());
+        g_entries.removeLast();
+    }
+}
+
+// Returns the entry for key moved to the front, or nullptr on a miss.
+SaveCacheEntry *touchLocked(const SaveCacheKey &key)
+{
+    for (int i = 0; i < g_entries.size(); ++i) {
+        if (sameKey(g_entries.at(i).key, key)) {
+            if (i > 0) {
+                g_entries.move(i, 0);
+            }
+            return &g_entries.first();
+        }
+    }
+    return nullptr;
+}
+
+void storeLocked(SaveCacheEntry entry)
+{
+    // Older versions of the same file can never be hit again.
+    for (int i = g_entries.size() - 1; i >= 0; --i) {
+        if (g_entries.at(i).key.canonicalPath == entry.key.canonicalPath) {
+            g_entries.removeAt(i);
+        }
+    }
+    g_entries.prepend(std::move(entry));
+    evictLocked();
+}
 }
 
 bool SaveCache::load(const QString &filePath, QByteArray *bytes, QJsonDocument *doc,
@@ -51,22 +132,33 @@ bool SaveCache::load(const QString &filePath, QByteArray *bytes, QJsonDocument *
         return false;
     }
 
-    const QString canonical = canonicalizePath(filePath, info);
-    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
-    const qint64 size = info.size();
+    const SaveCacheKey key = keyForFile(filePath, info);
 
+    std::shared_ptr<LosslessJsonDocument> serializeFrom;
+    bool hit = false;
     {
         QMutexLocker locker(&g_cacheMutex);
-        if (g_cache.valid && g_cache.canonicalPath == canonical
-            && g_cache.mtime == mtime && g_cache.size == size) {
+        const SaveCacheEntry *entry = touchLocked(key);
+        // An entry caught between dropping its bytes and storing the lossless
+        // document has no text to hand out; decode again instead.
+        if (entry && (!bytes || !entry->bytes.isEmpty() || entry->lossless)) {
             if (bytes) {
-                *bytes = g_cache.bytes;
+                *bytes = entry->bytes;
+                if (bytes->isEmpty()) {
+                    serializeFrom = entry->lossless;
+                }
             }
             if (doc) {
-                *doc = g_cache.doc;
+                *doc = entry->doc;
             }
-            return true;
+            hit = true;
+        }
+    }
+    if (hit) {
+        if (serializeFrom) {
+            *bytes = serializeFrom->toJson(false);
         }
+        return true;
     }
 
     QByteArray contentBytes;
@@ -107,12 +199,21 @@ bool SaveCache::load(const QString &filePath, QByteArray *bytes, QJsonDocument *
 
     {
         QMutexLocker locker(&g_cacheMutex);
-        g_cache.canonicalPath = canonical;
-        g_cache.mtime = mtime;
-        g_cache.size = size;
-        g_cache.bytes = contentBytes;
-        g_cache.doc = parsed;
-        g_cache.valid = true;
+        if (SaveCacheEntry *entry = touchLocked(key)) {
+            if (!entry->lossless) {
+                entry->bytes = contentBytes;
+            }
+            entry->jsonSize = contentBytes.size();
+            entry->doc = parsed;
+            evictLocked();
+        } else {
+            SaveCacheEntry entry;
+            entry.key = key;
+            entry.bytes = contentBytes;
+            entry.jsonSize = contentBytes.size();
+            entry.doc = parsed;
+            storeLocked(std::move(entry));
+        }
     }
 
     if (bytes) {
@@ -124,50 +225,63 @@ bool SaveCache::load(const QString &filePath, QByteArray *bytes, QJsonDocument *
     return true;
 }
 
-bool SaveCache::loadWithLossless(const QString &filePath, QByteArray *bytes, QJsonDocument *doc,
+bool SaveCache::loadWithLossless(const QString &filePath, QJsonDocument *doc,
                                  std::shared_ptr<LosslessJsonDocument> *lossless,
                                  QString *errorMessage)
 {
-    QByteArray localBytes;
-    QJsonDocument localDoc;
-    QByteArray *bytesOut = bytes ? bytes : &localBytes;
-    QJsonDocument *docOut = doc ? doc : &localDoc;
-
     if (lossless) {
         lossless->reset();
     }
 
-    if (!load(filePath, bytesOut, docOut, errorMessage)) {
-        return false;
-    }
-
     QFileInfo info(filePath);
-    const QString canonical = canonicalizePath(filePath, info);
-    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
-    const qint64 size = info.size();
+    const SaveCacheKey key = keyForFile(filePath, info);
 
     {
         QMutexLocker locker(&g_cacheMutex);
-        if (g_cache.valid && g_cache.canonicalPath == canonical
-            && g_cache.mtime == mtime && g_cache.size == size
-            && g_cache.lossless) {
+        const SaveCacheEntry *entry = touchLocked(key);
+        if (entry && entry->lossless) {
+            if (doc) {
+                *doc = entry->doc;
+            }
             if (lossless) {
-                *lossless = g_cache.lossless->clone();
+                *lossless = entry->lossless->clone();
             }
             return true;
         }
     }
 
+    QByteArray bytes;
+    QJsonDocument localDoc;
+    QJsonDocument *docOut = doc ? doc : &localDoc;
+    if (!load(filePath, &bytes, docOut, errorMessage)) {
+        return false;
+    }
+
+    // The lossless document keeps the text as its string buffer, so the entry
+    // lets go of its reference and the parse adopts bytes without a copy.
+    {
+        QMutexLocker locker(&g_cacheMutex);
+        if (SaveCacheEntry *entry = touchLocked(key)) {
+            if (entry->lossless) {
+                if (lossless) {
+                    *lossless = entry->lossless->clone();
+                }
+                return true;
+            }
+            entry->bytes = QByteArray();
+        }
+    }
+
     auto parsedLossless = std::make_shared<LosslessJsonDocument>();
-    if (!parsedLossless->parse(*bytesOut, errorMessage)) {
+    if (!parsedLossless->parse(std::move(bytes), errorMessage)) {
         return false;
     }
 
     {
         QMutexLocker locker(&g_cacheMutex);
-        if (g_cache.valid && g_cache.canonicalPath == canonical
-            && g_cache.mtime == mtime && g_cache.size == size) {
-            g_cache.lossless = parsedLossless;
+        if (SaveCacheEntry *entry = touchLocked(key)) {
+            entry->lossless = parsedLossless;
+            evictLocked();
         }
     }
 
@@ -177,8 +291,34 @@ bool SaveCache::loadWithLossless(const QString &filePath, QByteArray *bytes, QJs
     return true;
 }
 
+void SaveCache::install(const QString &filePath, const QJsonDocument &doc,
+                        const std::shared_ptr<LosslessJsonDocument> &lossless)
+{
+    QFileInfo info(filePath);
+    if (!lossless || !info.exists()) {
+        return;
+    }
+
+    SaveCacheEntry entry;
+    entry.key = keyForFile(filePath, info);
+    entry.lossless = lossless;
+    entry.jsonSize = lossless->sourceSize();
+    entry.doc = doc;
+
+    QMutexLocker locker(&g_cacheMutex);
+    storeLocked(std::move(entry));
+}
+
+void SaveCache::setLimits(int maxEntries, qint64 byteBudget)
+{
+    QMutexLocker locker(&g_cacheMutex);
+    g_maxEntries = qMax(1, maxEntries);
+    g_byteBudget = qMax<qint64>(0, byteBudget);
+    evictLocked();
+}
+
 void SaveCache::clear()
 {
     QMutexLocker locker(&g_cacheMutex);
-    g_cache = SaveCacheEntry();
+    g_entries.clear();
 }
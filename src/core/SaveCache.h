@@ -12,8 +12,15 @@ class SaveCache
 public:
     static bool load(const QString &filePath, QByteArray *bytes, QJsonDocument *doc,
                      QString *errorMessage = nullptr);
-    static bool loadWithLossless(const QString &filePath, QByteArray *bytes, QJsonDocument *doc,
+    // The lossless document takes over the decoded text, so the cache keeps
+    // one copy of it; load() serializes it again for callers asking for bytes.
+    static bool loadWithLossless(const QString &filePath, QJsonDocument *doc,
                                  std::shared_ptr<LosslessJsonDocument> *lossless,
                                  QString *errorMessage = nullptr);
+    // Records the just-written state of filePath so the next load is a hit.
+    // The cache keeps lossless as is, so the caller must not edit it afterwards.
+    static void install(const QString &filePath, const QJsonDocument &doc,
+                        const std::shared_ptr<LosslessJsonDocument> &lossless);
+    static void setLimits(int maxEntries, qint64 byteBudget);
     static void clear();
 };
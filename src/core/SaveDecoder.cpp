@@ -2,9 +2,13 @@
 
 #include <QByteArray>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QRegularExpression>
+#include <QVector>
+#include <QtConcurrent>
+#include <cstring>
 #include <limits>
 
 #include "lz4.h"
@@ -26,6 +30,83 @@ quint32 readLe32(const QByteArray &data, int offset)
            | (static_cast<quint32>(ptr[2]) << 16)
            | (static_cast<quint32>(ptr[3]) << 24);
 }
+
+struct SaveBlock {
+    qint64 compressedOffset = 0;
+    qint64 uncompressedOffset = 0;
+    int compressedSize = 0;
+    int uncompressedSize = 0;
+    int decodedSize = 0;
+};
+
+// Walks only the 16-byte chunk headers so every block's source and destination
+// slice is known before any decompression starts.
+bool indexBlocks(const QByteArray &data, qint64 offset, QVector<SaveBlock> *blocks,
+                 qint64 *totalSize, QString *errorMessage)
+{
+    const qint64 dataSize = data.size();
+    qint64 uncompressedOffset = 0;
+    while (offset + 16 <= dataSize) {
+        quint32 magic = readLe32(data, static_cast<int>(offset));
+        if (magic != kMagic) {
+            qWarning() << "SaveDecoder magic mismatch at offset" << offset << "magic=" << Qt::hex
+                       << magic << Qt::dec;
+            break;
+        }
+        quint32 compressedSize = readLe32(data, static_cast<int>(offset + 4));
+        quint32 uncompressedSize = readLe32(data, static_cast<int>(offset + 8));
+        if (debugSaveEnabled()) {
+            qInfo() << "Chunk sizes:" << compressedSize << uncompressedSize;
+        }
+        offset += 16;
+
+        if (compressedSize == 0 && uncompressedSize == 0) {
+            if (debugSaveEnabled()) {
+                qInfo() << "End of save data reached (terminal chunk)";
+            }
+            break;
+        }
+
+        if (compressedSize == 0 || uncompressedSize == 0) {
+            if (errorMessage) {
+                *errorMessage = QStringLiteral("Invalid save chunk size");
+            }
+            return false;
+        }
+        if (compressedSize > static_cast<quint32>(std::numeric_limits<int>::max())
+            || uncompressedSize > static_cast<quint32>(std::numeric_limits<int>::max())) {
+            if (errorMessage) {
+                *errorMessage = QStringLiteral("Save chunk too large");
+            }
+            return false;
+        }
+        if (compressedSize > static_cast<quint32>(kMaxChunkSize)
+            || uncompressedSize > static_cast<quint32>(kMaxChunkSize)) {
+            if (errorMessage) {
+                *errorMessage = QStringLiteral("Save chunk exceeds size limits");
+            }
+            return false;
+        }
+        if (offset + static_cast<qint64>(compressedSize) > dataSize) {
+            if (errorMessage) {
+                *errorMessage = QStringLiteral("Save chunk exceeds file size");
+            }
+            return false;
+        }
+
+        SaveBlock block;
+        block.compressedOffset = offset;
+        block.uncompressedOffset = uncompressedOffset;
+        block.compressedSize = static_cast<int>(compressedSize);
+        block.uncompressedSize = static_cast<int>(uncompressedSize);
+        blocks->append(block);
+
+        uncompressedOffset += static_cast<qint64>(uncompressedSize);
+        offset += static_cast<qint64>(compressedSize);
+    }
+    *totalSize = uncompressedOffset;
+    return true;
+}
 }
 
 QString SaveDecoder::decodeSave(const QString &filePath, QString *errorMessage)
@@ -59,7 +140,6 @@ QByteArray SaveDecoder::decodeSaveBytes(const QString &filePath, QString *errorM
     if (debugSaveEnabled()) {
         qInfo() << "Save file size:" << data.size();
     }
-    QByteArray output;
 
     // Find the first occurrence of kMagic to skip any external header
     qint64 offset = -1;
@@ -77,71 +157,65 @@ QByteArray SaveDecoder::decodeSaveBytes(const QString &filePath, QString *errorM
         return QByteArray();
     }
 
-    const qint64 dataSize = data.size();
-    while (offset + 16 <= dataSize) {
-        quint32 magic = readLe32(data, static_cast<int>(offset));
-        if (magic != kMagic) {
-            qWarning() << "SaveDecoder magic mismatch at offset" << offset << "magic=" << Qt::hex
-                       << magic << Qt::dec;
-            break;
-        }
-        quint32 compressedSize = readLe32(data, static_cast<int>(offset + 4));
-        quint32 uncompressedSize = readLe32(data, static_cast<int>(offset + 8));
-        if (debugSaveEnabled()) {
-            qInfo() << "Chunk sizes:" << compressedSize << uncompressedSize;
+    QVector<SaveBlock> blocks;
+    qint64 totalSize = 0;
+    if (!indexBlocks(data, offset, &blocks, &totalSize, errorMessage)) {
+        return QByteArray();
+    }
+    if (totalSize > static_cast<qint64>(std::numeric_limits<int>::max())) {
+        if (errorMessage) {
+            *errorMessage = QStringLiteral("Decoded save exceeds size limits");
         }
-        offset += 16;
+        return QByteArray();
+    }
 
-        if (compressedSize == 0 && uncompressedSize == 0) {
-            if (debugSaveEnabled()) {
-                qInfo() << "End of save data reached (terminal chunk)";
-            }
-            break;
-        }
+    QElapsedTimer timer;
+    timer.start();
 
-        if (compressedSize == 0 || uncompressedSize == 0) {
-            if (errorMessage) {
-                *errorMessage = QStringLiteral("Invalid save chunk size");
-            }
-            return QByteArray();
-        }
-        if (compressedSize > static_cast<quint32>(std::numeric_limits<int>::max())
-            || uncompressedSize > static_cast<quint32>(std::numeric_limits<int>::max())) {
-            if (errorMessage) {
-                *errorMessage = QStringLiteral("Save chunk too large");
-            }
-            return QByteArray();
-        }
-        if (compressedSize > static_cast<quint32>(kMaxChunkSize)
-            || uncompressedSize > static_cast<quint32>(kMaxChunkSize)) {
-            if (errorMessage) {
-                *errorMessage = QStringLiteral("Save chunk exceeds size limits");
-            }
-            return QByteArray();
-        }
-        if (offset + static_cast<qint64>(compressedSize) > dataSize) {
-            if (errorMessage) {
-                *errorMessage = QStringLiteral("Save chunk exceeds file size");
-            }
-            return QByteArray();
+    QByteArray output;
+    output.resize(static_cast<int>(totalSize));
+    char *outputData = output.data();
+    auto decodeBlock = [&data, outputData](SaveBlock &block) {
+        block.decodedSize = LZ4_decompress_safe(data.constData() + block.compressedOffset,
+                                                outputData + block.uncompressedOffset,
+                                                block.compressedSize,
+                                                block.uncompressedSize);
+    };
+    if (blocks.size() > 1) {
+        QtConcurrent::blockingMap(blocks, decodeBlock);
+    } else {
+        for (SaveBlock &block : blocks) {
+            decodeBlock(block);
         }
+    }
 
-        QByteArray decompressed;
-        decompressed.resize(static_cast<int>(uncompressedSize));
-        int decoded = LZ4_decompress_safe(data.constData() + offset, decompressed.data(),
-                                          static_cast<int>(compressedSize),
-                                          static_cast<int>(uncompressedSize));
-        if (decoded < 0) {
+    // Blocks were decoded in place; only a short block (decoded < declared size)
+    // forces the following slices to be shifted down to stay contiguous.
+    qint64 writeOffset = 0;
+    for (const SaveBlock &block : blocks) {
+        if (block.decodedSize < 0) {
             if (errorMessage) {
                 *errorMessage = QStringLiteral("LZ4 decompression failed");
             }
             return QByteArray();
         }
-        if (decoded != static_cast<int>(uncompressedSize)) {
-            qWarning() << "SaveDecoder: decoded size mismatch. Expected" << uncompressedSize << "but got" << decoded;
+        if (block.decodedSize != block.uncompressedSize) {
+            qWarning() << "SaveDecoder: decoded size mismatch. Expected" << block.uncompressedSize
+                       << "but got" << block.decodedSize;
         }
-        output.append(decompressed.left(decoded));
-        offset += static_cast<qint64>(compressedSize);
+        if (writeOffset != block.uncompressedOffset) {
+            memmove(outputData + writeOffset, outputData + block.uncompressedOffset,
+                    static_cast<size_t>(block.decodedSize));
+        }
+        writeOffset += block.decodedSize;
+    }
+    if (writeOffset != output.size()) {
+        output.truncate(static_cast<int>(writeOffset));
+    }
+
+    if (debugSaveEnabled()) {
+        qInfo() << "SaveDecoder decoded" << blocks.size() << "blocks," << output.size()
+                << "bytes in" << timer.elapsed() << "ms";
     }
 
     int lastObject = output.lastIndexOf('}');
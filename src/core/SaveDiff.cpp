@@ -0,0 +1,267 @@
+#include "core/SaveDiff.h"
+
+#include "core/JsonMapper.h"
+#include "core/LosslessJsonDocument.h"
+#include "core/SaveCache.h"
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+namespace {
+constexpr int kSummaryLength = 120;
+
+QString memberName(const rapidjson::Value &name)
+{
+    return QString::fromUtf8(name.GetString(), static_cast<int>(name.GetStringLength()));
+}
+
+QString summarize(const rapidjson::Value &value)
+{
+    if (value.IsObject()) {
+        return QObject::tr("{%n key(s)}", nullptr, static_cast<int>(value.MemberCount()));
+    }
+    if (value.IsArray()) {
+        return QObject::tr("[%n item(s)]", nullptr, static_cast<int>(value.Size()));
+    }
+    if (value.IsString()) {
+        QString text = QString::fromUtf8(value.GetString(), static_cast<int>(value.GetStringLength()));
+        if (text.size() > kSummaryLength) {
+            text = text.left(kSummaryLength) + QStringLiteral("...");
+        }
+        return QStringLiteral("\"%1\"").arg(text);
+    }
+    if (value.IsBool()) {
+        return value.GetBool() ? QStringLiteral("true") : QStringLiteral("false");
+    }
+    if (value.IsNull()) {
+        return QStringLiteral("null");
+    }
+    if (value.IsInt64()) {
+        return QString::number(value.GetInt64());
+    }
+    if (value.IsUint64()) {
+        return QString::number(value.GetUint64());
+    }
+    return QString::number(value.GetDouble(), 'g', 17);
+}
+
+class Differ
+{
+public:
+    Differ(const LosslessJsonDocument &before, const LosslessJsonDocument &after)
+        : before_(before)
+        , after_(after)
+    {
+        // Saves store short keys; accept both spellings of each identity key.
+        for (const char *name : {"UID", "Id", "ID", "Index"}) {
+            const QString readable = QString::fromLatin1(name);
+            const QString shortKey = JsonMapper::unmapKey(readable);
+            if (shortKey != readable) {
+                identityKeys_.append(shortKey.toUtf8());
+            }
+            identityKeys_.append(readable.toUtf8());
+        }
+    }
+
+    void diffValues(const rapidjson::Value &before, const rapidjson::Value &after, QVariantList &path)
+    {
+        if (result.truncated) {
+            return;
+        }
+        if (before_.hash(before) == after_.hash(after)) {
+            return;
+        }
+        if (before.IsObject() && after.IsObject()) {
+            diffObjects(before, after, path);
+        } else if (before.IsArray() && after.IsArray()) {
+            diffArrays(before, after, path);
+        } else {
+            record(SaveDiffChange::Kind::Changed, path, &before, &after);
+        }
+    }
+
+    SaveDiffResult result;
+
+private:
+    void record(SaveDiffChange::Kind kind, const QVariantList &path,
+                const rapidjson::Value *before, const rapidjson::Value *after)
+    {
+        if (result.changes.size() >= SaveDiff::kMaxChanges) {
+            result.truncated = true;
+            return;
+        }
+        SaveDiffChange change;
+        change.kind = kind;
+        change.path = path;
+        if (before) {
+            change.before = summarize(*before);
+        }
+        if (after) {
+            change.after = summarize(*after);
+        }
+        result.changes.append(change);
+    }
+
+    void diffObjects(const rapidjson::Value &before, const rapidjson::Value &after, QVariantList &path)
+    {
+        for (auto it = before.MemberBegin(); it != before.MemberEnd(); ++it) {
+            path.append(memberName(it->name));
+            auto match = after.FindMember(it->name);
+            if (match == after.MemberEnd()) {
+                record(SaveDiffChange::Kind::Removed, path, &it->value, nullptr);
+            } else {
+                diffValues(it->value, match->value, path);
+            }
+            path.removeLast();
+        }
+        for (auto it = after.MemberBegin(); it != after.MemberEnd(); ++it) {
+            if (!before.HasMember(it->name)) {
+                path.append(memberName(it->name));
+                record(SaveDiffChange::Kind::Added, path, nullptr, &it->value);
+                path.removeLast();
+            }
+        }
+    }
+
+    // Picks the first identity key that every element of both arrays carries
+    // with a distinct value, or returns null when elements must pair by position.
+    const QByteArray *identityKeyFor(const rapidjson::Value &before, const rapidjson::Value &after)
+    {
+        for (const QByteArray &key : identityKeys_) {
+            const rapidjson::Value name(rapidjson::StringRef(key.constData(),
+                                                             static_cast<rapidjson::SizeType>(key.size())));
+            if (identitiesUnique(before, name, before_) && identitiesUnique(after, name, after_)) {
+                return &key;
+            }
+        }
+        return nullptr;
+    }
+
+    bool identitiesUnique(const rapidjson::Value &array, const rapidjson::Value &name,
+                          const LosslessJsonDocument &doc)
+    {
+        QSet<quint64> seen;
+        seen.reserve(static_cast<int>(array.Size()));
+        for (const rapidjson::Value &element : array.GetArray()) {
+            if (!element.IsObject()) {
+                return false;
+            }
+            auto member = element.FindMember(name);
+            if (member == element.MemberEnd()) {
+                return false;
+            }
+            const quint64 identity = doc.hash(member->value);
+            if (seen.contains(identity)) {
+                return false;
+            }
+            seen.insert(identity);
+        }
+        return true;
+    }
+
+    void diffArrays(const rapidjson::Value &before, const rapidjson::Value &after, QVariantList &path)
+    {
+        const QByteArray *key = (before.Empty() || after.Empty()) ? nullptr : identityKeyFor(before, after);
+        if (!key) {
+            const rapidjson::SizeType common = qMin(before.Size(), after.Size());
+            for (rapidjson::SizeType i = 0; i < common; ++i) {
+                path.append(static_cast<int>(i));
+                diffValues(before[i], after[i], path);
+                path.removeLast();
+            }
+            for (rapidjson::SizeType i = common; i < before.Size(); ++i) {
+                path.append(static_cast<int>(i));
+                record(SaveDiffChange::Kind::Removed, path, &before[i], nullptr);
+                path.removeLast();
+            }
+            for (rapidjson::SizeType i = common; i < after.Size(); ++i) {
+                path.append(static_cast<int>(i));
+                record(SaveDiffChange::Kind::Added, path, nullptr, &after[i]);
+                path.removeLast();
+            }
+            return;
+        }
+
+        const rapidjson::Value name(rapidjson::StringRef(key->constData(),
+                                                         static_cast<rapidjson::SizeType>(key->size())));
+        QHash<quint64, int> afterByIdentity;
+        afterByIdentity.reserve(static_cast<int>(after.Size()));
+        for (rapidjson::SizeType i = 0; i < after.Size(); ++i) {
+            afterByIdentity.insert(after_.hash(after[i].FindMember(name)->value), static_cast<int>(i));
+        }
+        QSet<int> matched;
+        for (rapidjson::SizeType i = 0; i < before.Size(); ++i) {
+            const quint64 identity = before_.hash(before[i].FindMember(name)->value);
+            const int afterIndex = afterByIdentity.value(identity, -1);
+            if (afterIndex < 0) {
+                path.append(static_cast<int>(i));
+                record(SaveDiffChange::Kind::Removed, path, &before[i], nullptr);
+            } else {
+                matched.insert(afterIndex);
+                path.append(afterIndex);
+                diffValues(before[i], after[static_cast<rapidjson::SizeType>(afterIndex)], path);
+            }
+            path.removeLast();
+        }
+        for (rapidjson::SizeType i = 0; i < after.Size(); ++i) {
+            if (!matched.contains(static_cast<int>(i))) {
+                path.append(static_cast<int>(i));
+                record(SaveDiffChange::Kind::Added, path, nullptr, &after[i]);
+                path.removeLast();
+            }
+        }
+    }
+
+    const LosslessJsonDocument &before_;
+    const LosslessJsonDocument &after_;
+    QList<QByteArray> identityKeys_;
+};
+}
+
+namespace SaveDiff {
+SaveDiffResult diff(const LosslessJsonDocument &before, const LosslessJsonDocument &after)
+{
+    if (&before == &after) {
+        return SaveDiffResult();
+    }
+    QReadLocker beforeLocker(before.lock());
+    QReadLocker afterLocker(after.lock());
+    Differ differ(before, after);
+    QVariantList path;
+    differ.diffValues(before.root(), after.root(), path);
+    return differ.result;
+}
+
+SaveDiffResult compareFiles(const QString &beforePath, const QString &afterPath,
+                            const std::shared_ptr<LosslessJsonDocument> &afterDoc)
+{
+    SaveDiffResult result;
+    std::shared_ptr<LosslessJsonDocument> before;
+    if (!SaveCache::loadWithLossless(beforePath, nullptr, &before, &result.errorMessage)) {
+        return result;
+    }
+    std::shared_ptr<LosslessJsonDocument> after = afterDoc;
+    if (!after && !SaveCache::loadWithLossless(afterPath, nullptr, &after, &result.errorMessage)) {
+        return result;
+    }
+    if (!before || !after) {
+        result.errorMessage = QObject::tr("Failed to load lossless JSON.");
+        return result;
+    }
+    return diff(*before, *after);
+}
+
+QString kindLabel(SaveDiffChange::Kind kind)
+{
+    switch (kind) {
+    case SaveDiffChange::Kind::Added:
+        return QObject::tr("Added");
+    case SaveDiffChange::Kind::Removed:
+        return QObject::tr("Removed");
+    case SaveDiffChange::Kind::Changed:
+        break;
+    }
+    return QObject::tr("Changed");
+}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QVariantList>
+#include <memory>
+
+class LosslessJsonDocument;
+
+struct SaveDiffChange {
+    enum class Kind { Added, Removed, Changed };
+
+    Kind kind = Kind::Changed;
+    // Addresses the after document, except for removals which address before.
+    QVariantList path;
+    QString before;
+    QString after;
+};
+
+struct SaveDiffResult {
+    QList<SaveDiffChange> changes;
+    bool truncated = false;
+    QString errorMessage;
+};
+
+namespace SaveDiff {
+constexpr int kMaxChanges = 10000;
+
+// Structural diff of two documents. Identical subtrees are skipped by hash,
+// and arrays of objects are matched by UID/Id/Index-style keys when every
+// element carries a unique one, falling back to position otherwise.
+SaveDiffResult diff(const LosslessJsonDocument &before, const LosslessJsonDocument &after);
+// Loads both saves (or uses afterDoc when given) and diffs them; meant to run
+// on a worker thread.
+SaveDiffResult compareFiles(const QString &beforePath, const QString &afterPath,
+                            const std::shared_ptr<LosslessJsonDocument> &afterDoc);
+QString kindLabel(SaveDiffChange::Kind kind);
+}
@@ -0,0 +1,36 @@
+#include "core/SaveEditTransaction.h"
+
+#include "core/SaveJsonModel.h"
+
+void SaveEditTransaction::recordWrite(const QVariantList &path)
+{
+    if (!pending_) {
+        pending_ = true;
+        commonPath_ = path;
+        return;
+    }
+    int shared = 0;
+    const int limit = qMin(commonPath_.size(), path.size());
+    while (shared < limit && commonPath_.at(shared) == path.at(shared)) {
+        ++shared;
+    }
+    commonPath_.resize(shared);
+}
+
+bool SaveEditTransaction::commit(const std::shared_ptr<LosslessJsonDocument> &lossless,
+                                 QJsonDocument &rootDoc, QVariantList *changedPath)
+{
+    if (depth_ == 0 || --depth_ > 0 || !pending_) {
+        return false;
+    }
+    const QVariantList path = commonPath_;
+    pending_ = false;
+    commonPath_.clear();
+    if (lossless) {
+        SaveJsonModel::syncRootPathFromLossless(lossless, rootDoc, path);
+    }
+    if (changedPath) {
+        *changedPath = path;
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QJsonDocument>
+#include <QVariantList>
+#include <memory>
+
+class LosslessJsonDocument;
+
+// Groups the lossless writes of one user action so the page resyncs its Qt
+// document and reports the edit once instead of per path. Transactions nest;
+// only the outermost commit syncs. Until then, reads through the Qt document
+// still see the values from before the transaction.
+class SaveEditTransaction
+{
+public:
+    void begin() { ++depth_; }
+    bool isActive() const { return depth_ > 0; }
+
+    // Records a write made while a transaction is open.
+    void recordWrite(const QVariantList &path);
+
+    // Closes one level. When the outermost level closes with pending writes,
+    // rootDoc is refreshed from lossless under the writes' deepest common
+    // path, which is returned through changedPath, and true is returned.
+    bool commit(const std::shared_ptr<LosslessJsonDocument> &lossless, QJsonDocument &rootDoc,
+                QVariantList *changedPath);
+
+private:
+    int depth_ = 0;
+    bool pending_ = false;
+    QVariantList commonPath_;
+};
@@ -1,6 +1,8 @@
 #include "core/SaveEncoder.h"
 
 #include <QByteArray>
+#include <QByteArrayView>
+#include <QCryptographicHash>
 #include <QFile>
 #include <QJsonDocument>
 
@@ -8,20 +10,21 @@
 #include "core/ManifestManager.h"
 #include <QDir>
 #include <QRegularExpression>
+#include <QSaveFile>
+#include <QVector>
+#include <QtConcurrent>
+#include <cstring>
 
 namespace {
 constexpr quint32 kMagic = 0xFEEDA1E5;
 constexpr int kDefaultBlockSize = 0x10000;
 
-QByteArray intToLe32(quint32 value)
+void writeLe32(char *out, quint32 value)
 {
-    QByteArray bytes;
-    bytes.resize(4);
-    bytes[0] = static_cast<char>(value & 0xFF);
-    bytes[1] = static_cast<char>((value >> 8) & 0xFF);
-    bytes[2] = static_cast<char>((value >> 16) & 0xFF);
-    bytes[3] = static_cast<char>((value >> 24) & 0xFF);
-    return bytes;
+    out[0] = static_cast<char>(value & 0xFF);
+    out[1] = static_cast<char>((value >> 8) & 0xFF);
+    out[2] = static_cast<char>((value >> 16) & 0xFF);
+    out[3] = static_cast<char>((value >> 24) & 0xFF);
 }
 
 quint32 readLe32(const QByteArray &data, int offset)
@@ -156,7 +159,7 @@ int countTrailingNulls(const QByteArray &data)
     return count;
 }
 
-int detectTrailingNulls(const QByteArray &data)
+int detectTrailingNullsFullDecode(const QByteArray &data)
 {
     QByteArray output = decodeRawPayload(data);
     if (output.isEmpty()) {
@@ -172,6 +175,68 @@ int detectTrailingNulls(const QByteArray &data)
     return countTrailingNulls(tail);
 }
 
+struct ChunkLocation {
+    int offset = 0;
+    int compressedSize = 0;
+    int uncompressedSize = 0;
+};
+
+// Only the tail of the payload matters, so decode blocks from the end and stop
+// at the first one that holds data; normally that is just the last block.
+int detectTrailingNulls(const QByteArray &data)
+{
+    int offset = findHeaderEnd(data);
+    if (offset < 0) {
+        return 0;
+    }
+    QVector<ChunkLocation> chunks;
+    const qint64 dataSize = data.size();
+    while (offset + 16 <= dataSize) {
+        if (readLe32(data, offset) != kMagic) {
+            break;
+        }
+        quint32 compressedSize = readLe32(data, offset + 4);
+        quint32 uncompressedSize = readLe32(data, offset + 8);
+        offset += 16;
+        if (compressedSize == 0 || uncompressedSize == 0) {
+            break;
+        }
+        if (offset + static_cast<qint64>(compressedSize) > dataSize) {
+            break;
+        }
+        ChunkLocation chunk;
+        chunk.offset = offset;
+        chunk.compressedSize = static_cast<int>(compressedSize);
+        chunk.uncompressedSize = static_cast<int>(uncompressedSize);
+        chunks.append(chunk);
+        offset += static_cast<int>(compressedSize);
+    }
+
+    int count = 0;
+    QByteArray decompressed;
+    for (int i = chunks.size() - 1; i >= 0; --i) {
+        const ChunkLocation &chunk = chunks.at(i);
+        decompressed.resize(chunk.uncompressedSize);
+        int decoded = LZ4_decompress_safe(data.constData() + chunk.offset, decompressed.data(),
+                                          chunk.compressedSize, chunk.uncompressedSize);
+        if (decoded < 0) {
+            return 0;
+        }
+        decompressed.truncate(decoded);
+        int blockNulls = countTrailingNulls(decompressed);
+        if (blockNulls == decompressed.size()) {
+            count += blockNulls;
+            continue;
+        }
+        int lastGood = qMax(decompressed.lastIndexOf('}'), decompressed.lastIndexOf(']'));
+        if (lastGood < 0) {
+            return detectTrailingNullsFullDecode(data);
+        }
+        return count + blockNulls;
+    }
+    return 0;
+}
+
 bool debugSaveEnabled()
 {
     return qEnvironmentVariableIntValue("NMSSE_DEBUG_SAVE") == 1;
@@ -191,19 +256,11 @@ void logSaveFormat(const QString &path, const BlockFormatInfo &info)
             << "trailingNulls=" << info.trailingNulls;
 }
 
-void logWrittenFileSummary(const QString &path)
+void logWrittenFileSummary(const QString &path, const QByteArray &data)
 {
     if (!debugSaveEnabled()) {
         return;
     }
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qInfo() << "SaveEncoder post-write: unable to read" << path;
-        return;
-    }
-    QByteArray data = file.readAll();
-    file.close();
-
     qint64 offset = -1;
     for (int i = 0; i + 4 <= data.size(); ++i) {
         if (readLe32(data, i) == kMagic) {
@@ -258,6 +315,103 @@ int slotIndexForSaveName(const QString &fileName)
     }
     return 0;
 }
+
+struct EncodeBlock {
+    int sourceOffset = 0;
+    int sourceSize = 0;
+    int uncompressedSize = 0;
+    qint64 arenaOffset = 0;
+    int arenaCapacity = 0;
+    int compressedSize = 0;
+};
+
+// Compresses every block of the payload on the worker pool into one arena, then
+// lays out header, chunk headers, bodies and the terminal sentinel contiguously
+// so the file can be written in a single call. The manifest SHA-256 is fed as
+// each piece is emitted.
+bool encodeBlocks(const QByteArray &header, const QByteArray &payload,
+                  const BlockFormatInfo &formatInfo, QByteArray *fileBytes,
+                  QCryptographicHash *sha256, QString *errorMessage)
+{
+    const int blockSize = formatInfo.blockSize;
+    QVector<EncodeBlock> blocks;
+    blocks.reserve(payload.size() / blockSize + 1);
+    qint64 arenaSize = 0;
+    for (int offset = 0; offset < payload.size(); offset += blockSize) {
+        EncodeBlock block;
+        block.sourceOffset = offset;
+        block.sourceSize = qMin(blockSize, payload.size() - offset);
+        block.uncompressedSize = (formatInfo.padToBlock && block.sourceSize < blockSize)
+                                     ? blockSize
+                                     : block.sourceSize;
+        block.arenaOffset = arenaSize;
+        block.arenaCapacity = LZ4_compressBound(block.uncompressedSize);
+        arenaSize += block.arenaCapacity;
+        blocks.append(block);
+    }
+
+    QByteArray arena;
+    arena.resize(static_cast<int>(arenaSize));
+    char *arenaData = arena.data();
+    auto compressBlock = [&payload, arenaData](EncodeBlock &block) {
+        const char *source = payload.constData() + block.sourceOffset;
+        QByteArray padded;
+        if (block.uncompressedSize != block.sourceSize) {
+            padded = QByteArray(block.uncompressedSize, '\0');
+            memcpy(padded.data(), source, block.sourceSize);
+            source = padded.constData();
+        }
+        block.compressedSize = LZ4_compress_default(source, arenaData + block.arenaOffset,
+                                                    block.uncompressedSize, block.arenaCapacity);
+    };
+    if (blocks.size() > 1) {
+        QtConcurrent::blockingMap(blocks, compressBlock);
+    } else {
+        for (EncodeBlock &block : blocks) {
+            compressBlock(block);
+        }
+    }
+
+    qint64 totalSize = header.size();
+    for (const EncodeBlock &block : blocks) {
+        if (block.compressedSize <= 0) {
+            if (errorMessage) {
+                *errorMessage = QStringLiteral("LZ4 compression failed");
+            }
+            return false;
+        }
+        totalSize += 16 + block.compressedSize;
+    }
+    if (formatInfo.hasTerminalChunk) {
+        totalSize += 16;
+    }
+
+    QByteArray out(static_cast<int>(totalSize), '\0');
+    char *cursor = out.data();
+    if (!header.isEmpty()) {
+        memcpy(cursor, header.constData(), header.size());
+        sha256->addData(QByteArrayView(cursor, header.size()));
+        cursor += header.size();
+    }
+    for (const EncodeBlock &block : blocks) {
+        char *chunkStart = cursor;
+        writeLe32(cursor, kMagic);
+        writeLe32(cursor + 4, static_cast<quint32>(block.compressedSize));
+        writeLe32(cursor + 8, static_cast<quint32>(block.uncompressedSize));
+        cursor += 16;
+        memcpy(cursor, arenaData + block.arenaOffset, block.compressedSize);
+        cursor += block.compressedSize;
+        sha256->addData(QByteArrayView(chunkStart, cursor - chunkStart));
+    }
+    if (formatInfo.hasTerminalChunk) {
+        // EOF sentinel — exactly 16 bytes (Magic + 12 zeros)
+        writeLe32(cursor, kMagic);
+        sha256->addData(QByteArrayView(cursor, 16));
+    }
+
+    *fileBytes = out;
+    return true;
+}
 }
 
 bool SaveEncoder::encodeSave(const QString &filePath, const QJsonObject &saveData, QString *errorMessage)
@@ -283,7 +437,6 @@ bool SaveEncoder::encodeSave(const QString &filePath, const QByteArray &json, QS
     QByteArray header;
     BlockFormatInfo formatInfo = detectBlockFormat(originalBytes, headerEnd < 0 ? 0 : headerEnd);
     formatInfo.trailingNulls = detectTrailingNulls(originalBytes);
-    int blockSize = formatInfo.blockSize;
     logSaveFormat(filePath, formatInfo);
     if (headerEnd >= 0) {
         header = originalBytes.left(headerEnd);
@@ -296,86 +449,81 @@ bool SaveEncoder::encodeSave(const QString &filePath, const QByteArray &json, QS
         payload.append(QByteArray(formatInfo.trailingNulls, '\0'));
     }
 
-    QFile out(filePath);
-    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    QByteArray fileBytes;
+    QCryptographicHash sha256(QCryptographicHash::Sha256);
+    if (!encodeBlocks(header, payload, formatInfo, &fileBytes, &sha256, errorMessage)) {
+        return false;
+    }
+
+    QFileInfo saveInfo(filePath);
+    QString mfName = saveInfo.fileName().replace("save", "mf_save");
+    QString mfPath = QDir(saveInfo.absolutePath()).filePath(mfName);
+    int slotIdx = slotIndexForSaveName(saveInfo.fileName());
+
+    QByteArray manifestBytes;
+    const bool updateManifest = qEnvironmentVariableIntValue("NMSSE_SKIP_MANIFEST") != 1
+                                && QFile::exists(mfPath);
+    // The game rejects a save whose manifest does not match it, so a manifest
+    // that cannot be rebuilt fails the write before either file is touched.
+    if (updateManifest
+        && !ManifestManager::buildManifest(mfPath, slotIdx, fileBytes, sha256.result(),
+                                           ManifestData(), &manifestBytes)) {
         if (errorMessage) {
-            *errorMessage = QString("Unable to write %1").arg(filePath);
+            *errorMessage = QString("Unable to update manifest %1").arg(mfPath);
         }
         return false;
     }
 
-    if (!header.isEmpty()) {
-        out.write(header);
+    // Stage the save and its manifest side by side; neither live file is touched
+    // until both temporaries are fully written.
+    QSaveFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("Unable to write %1").arg(filePath);
+        }
+        return false;
+    }
+    if (out.write(fileBytes) != fileBytes.size()) {
+        if (errorMessage) {
+            *errorMessage = QString("Failed to write %1").arg(filePath);
+        }
+        return false;
     }
 
-    int offset = 0;
-    while (offset < payload.size()) {
-        int chunkSize = qMin(blockSize, payload.size() - offset);
-
-        QByteArray block;
-        int uncompressedSize = chunkSize;
-        if (formatInfo.padToBlock && chunkSize < blockSize) {
-            block = QByteArray(blockSize, '\0');
-            memcpy(block.data(), payload.constData() + offset, chunkSize);
-            uncompressedSize = blockSize;
-        } else {
-            block = payload.mid(offset, chunkSize);
-        }
-
-        int maxCompressedSize = LZ4_compressBound(uncompressedSize);
-        QByteArray compressed;
-        compressed.resize(maxCompressedSize);
-
-        int compressedSize = LZ4_compress_default(block.constData(), compressed.data(),
-                                                   uncompressedSize, maxCompressedSize);
-        if (compressedSize <= 0) {
+    QSaveFile manifestOut(mfPath);
+    if (updateManifest) {
+        if (!manifestOut.open(QIODevice::WriteOnly)
+            || manifestOut.write(manifestBytes) != manifestBytes.size()) {
             if (errorMessage) {
-                *errorMessage = QStringLiteral("LZ4 compression failed");
+                *errorMessage = QString("Unable to write %1").arg(mfPath);
             }
             return false;
         }
-        compressed.truncate(compressedSize);
-
-        out.write(intToLe32(kMagic));
-        out.write(intToLe32(static_cast<quint32>(compressedSize)));
-        out.write(intToLe32(static_cast<quint32>(uncompressedSize)));
-        out.write(intToLe32(0));
-        out.write(compressed);
-
-        offset += chunkSize;
     }
 
-    if (formatInfo.hasTerminalChunk) {
-        // EOF sentinel — exactly 16 bytes (Magic + 12 zeros)
-        out.write(intToLe32(kMagic));
-        out.write(QByteArray(12, '\0'));
+    if (!out.commit()) {
+        if (errorMessage) {
+            *errorMessage = QString("Failed to finalize %1").arg(filePath);
+        }
+        return false;
     }
-
-    out.flush();
-    out.close();
-    logWrittenFileSummary(filePath);
-
-    QFileInfo saveInfo(filePath);
-    QString mfName = saveInfo.fileName().replace("save", "mf_save");
-    QString mfPath = QDir(saveInfo.absolutePath()).filePath(mfName);
-    int slotIdx = slotIndexForSaveName(saveInfo.fileName());
-
-    if (qEnvironmentVariableIntValue("NMSSE_SKIP_MANIFEST") != 1 && QFile::exists(mfPath)) {
-        QFile finalSave(filePath);
-        if (finalSave.open(QIODevice::ReadOnly)) {
-            QByteArray finalBytes = finalSave.readAll();
-            finalSave.close();
-            ManifestManager::writeManifest(mfPath, slotIdx, finalBytes, ManifestData());
+    if (updateManifest && !manifestOut.commit()) {
+        // The save was replaced but its manifest was not; put the previous save
+        // back so the pair stays consistent.
+        QSaveFile rollback(filePath);
+        if (rollback.open(QIODevice::WriteOnly)
+            && rollback.write(originalBytes) == originalBytes.size()) {
+            rollback.commit();
+        }
+        if (errorMessage) {
+            *errorMessage = QString("Failed to update manifest %1").arg(mfPath);
         }
+        return false;
     }
+    logWrittenFileSummary(filePath, fileBytes);
 
     if (QFile::exists(mfPath) && (debugSaveEnabled() || qEnvironmentVariableIntValue("NMSSE_DEBUG_MANIFEST") == 1)) {
-        QFile finalSave(filePath);
-        if (finalSave.open(QIODevice::ReadOnly)) {
-            QByteArray finalBytes = finalSave.readAll();
-            finalSave.close();
-            ManifestManager::logManifestValidation(mfPath, slotIdx, finalBytes);
-        }
+        ManifestManager::logManifestValidation(mfPath, slotIdx, fileBytes);
     }
 
     return true;
@@ -347,3 +347,23 @@ QList<SaveSlot> SaveGameLocator::scanDirectory(const QString &path)
 
     return saveSlots;
 }
+
+const SaveSlot *SaveGameLocator::findSlotForFile(const QList<SaveSlot> &slots, const QString &filePath)
+{
+    QString target = QFileInfo(filePath).canonicalFilePath();
+    if (target.isEmpty()) {
+        target = QFileInfo(filePath).absoluteFilePath();
+    }
+    for (const SaveSlot &slot : slots) {
+        for (const SaveSlot::SaveFileEntry &entry : slot.saveFiles) {
+            QString candidate = QFileInfo(entry.filePath).canonicalFilePath();
+            if (candidate.isEmpty()) {
+                candidate = QFileInfo(entry.filePath).absoluteFilePath();
+            }
+            if (!candidate.isEmpty() && candidate == target) {
+                return &slot;
+            }
+        }
+    }
+    return nullptr;
+}
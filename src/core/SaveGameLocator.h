@@ -36,6 +36,8 @@ class SaveGameLocator
 public:
     static QList<SaveSlot> discoverSaveSlots();
     static QList<SaveSlot> scanDirectory(const QString &path);
+    // The slot in slots that lists filePath, compared by canonical path.
+    static const SaveSlot *findSlotForFile(const QList<SaveSlot> &slots, const QString &filePath);
 };
 
 Q_DECLARE_METATYPE(SaveSlot)
@@ -5,8 +5,88 @@
 #include "core/ResourceLocator.h"
 #include "core/Utf8Diagnostics.h"
 
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QJsonParseError>
 
+#include <rapidjson/document.h>
+
+namespace {
+QJsonValue toQtValue(const rapidjson::Value &value)
+{
+    if (value.IsNull()) {
+        return QJsonValue(QJsonValue::Null);
+    }
+    if (value.IsBool()) {
+        return QJsonValue(value.GetBool());
+    }
+    if (value.IsInt64()) {
+        return QJsonValue(static_cast<qint64>(value.GetInt64()));
+    }
+    if (value.IsNumber()) {
+        return QJsonValue(value.GetDouble());
+    }
+    if (value.IsString()) {
+        return QJsonValue(decodeJsonUtf8ForQt(value.GetString(),
+                                              static_cast<int>(value.GetStringLength())));
+    }
+    if (value.IsArray()) {
+        QJsonArray arr;
+        for (auto it = value.Begin(); it != value.End(); ++it) {
+            arr.append(toQtValue(*it));
+        }
+        return arr;
+    }
+    if (value.IsObject()) {
+        QJsonObject obj;
+        for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
+            obj.insert(decodeJsonUtf8ForQt(it->name.GetString(),
+                                           static_cast<int>(it->name.GetStringLength())),
+                       toQtValue(it->value));
+        }
+        return obj;
+    }
+    return QJsonValue(QJsonValue::Null);
+}
+
+QJsonValue replaceAtPath(const QJsonValue &node, const QVariantList &path, int depth,
+                         const QJsonValue &value, bool *ok)
+{
+    if (depth == path.size()) {
+        return value;
+    }
+    const QVariant &segment = path.at(depth);
+    const bool leaf = depth == path.size() - 1;
+    if (segment.canConvert<int>() && node.isArray()) {
+        QJsonArray arr = node.toArray();
+        int index = segment.toInt();
+        if (index < 0 || index >= arr.size()) {
+            *ok = false;
+            return node;
+        }
+        arr.replace(index, replaceAtPath(arr.at(index), path, depth + 1, value, ok));
+        return arr;
+    }
+    if (segment.canConvert<QString>() && node.isObject()) {
+        QJsonObject obj = node.toObject();
+        QString key = segment.toString();
+        auto it = obj.constFind(key);
+        if (it == obj.constEnd()) {
+            if (!leaf) {
+                *ok = false;
+                return node;
+            }
+            obj.insert(key, value);
+            return obj;
+        }
+        obj.insert(key, replaceAtPath(it.value(), path, depth + 1, value, ok));
+        return obj;
+    }
+    *ok = false;
+    return node;
+}
+}
+
 namespace SaveJsonModel {
 bool ensureMappingLoaded()
 {
@@ -20,13 +100,7 @@ bool ensureMappingLoaded()
 QVariantList remapPathToShort(const QVariantList &path)
 {
     ensureMappingLoaded();
-    QHash<QString, QString> reverse;
-    const QHash<QString, QString> mapping = JsonMapper::mapping();
-    for (auto it = mapping.begin(); it != mapping.end(); ++it) {
-        if (!reverse.contains(it.value())) {
-            reverse.insert(it.value(), it.key());
-        }
-    }
+    const QHash<QString, QString> &reverse = JsonMapper::reverseMapping();
 
     QVariantList out;
     out.reserve(path.size());
@@ -57,6 +131,22 @@ bool setLosslessValue(const std::shared_ptr<LosslessJsonDocument> &lossless,
     return false;
 }
 
+bool setLosslessValue(const std::shared_ptr<LosslessJsonDocument> &lossless,
+                      const JsonPath &path, const QJsonValue &value)
+{
+    if (!lossless) {
+        return false;
+    }
+    if (lossless->setValueAtPath(path, value)) {
+        return true;
+    }
+    QVariantList remapped = remapPathToShort(path.toVariantList());
+    if (remapped != path.toVariantList()) {
+        return lossless->setValueAtPath(remapped, value);
+    }
+    return false;
+}
+
 bool syncRootFromLossless(const std::shared_ptr<LosslessJsonDocument> &lossless,
                           QJsonDocument &rootDoc, QString *errorMessage)
 {
@@ -80,4 +170,40 @@ bool syncRootFromLossless(const std::shared_ptr<LosslessJsonDocument> &lossless,
     rootDoc = doc;
     return true;
 }
+
+bool syncRootPathFromLossless(const std::shared_ptr<LosslessJsonDocument> &lossless,
+                              QJsonDocument &rootDoc, const QVariantList &path,
+                              QString *errorMessage)
+{
+    if (!lossless) {
+        return false;
+    }
+    if (path.isEmpty() || rootDoc.isNull()) {
+        return syncRootFromLossless(lossless, rootDoc, errorMessage);
+    }
+
+    QVariantList resolvedPath = path;
+    const rapidjson::Value *node = lossless->valueAtPath(resolvedPath);
+    if (!node) {
+        resolvedPath = remapPathToShort(path);
+        node = resolvedPath != path ? lossless->valueAtPath(resolvedPath) : nullptr;
+    }
+    if (!node) {
+        return syncRootFromLossless(lossless, rootDoc, errorMessage);
+    }
+
+    QJsonValue rootValue = rootDoc.isObject() ? QJsonValue(rootDoc.object())
+                                              : QJsonValue(rootDoc.array());
+    bool ok = true;
+    QJsonValue updated = replaceAtPath(rootValue, resolvedPath, 0, toQtValue(*node), &ok);
+    if (updated.isObject()) {
+        rootDoc.setObject(updated.toObject());
+    } else if (updated.isArray()) {
+        rootDoc.setArray(updated.toArray());
+    }
+    if (!ok) {
+        return syncRootFromLossless(lossless, rootDoc, errorMessage);
+    }
+    return true;
+}
 }
@@ -4,6 +4,8 @@
 #include <QVariantList>
 #include <memory>
 
+#include "core/JsonPath.h"
+
 class LosslessJsonDocument;
 
 namespace SaveJsonModel {
@@ -11,6 +13,14 @@ bool ensureMappingLoaded();
 QVariantList remapPathToShort(const QVariantList &path);
 bool setLosslessValue(const std::shared_ptr<LosslessJsonDocument> &lossless,
                       const QVariantList &path, const QJsonValue &value);
+bool setLosslessValue(const std::shared_ptr<LosslessJsonDocument> &lossless,
+                      const JsonPath &path, const QJsonValue &value);
 bool syncRootFromLossless(const std::shared_ptr<LosslessJsonDocument> &lossless,
                           QJsonDocument &rootDoc, QString *errorMessage = nullptr);
+// Refreshes only the subtree of rootDoc addressed by path (or its short-key
+// form) from the lossless document; falls back to a full sync when the path
+// cannot be matched on both sides.
+bool syncRootPathFromLossless(const std::shared_ptr<LosslessJsonDocument> &lossless,
+                              QJsonDocument &rootDoc, const QVariantList &path,
+                              QString *errorMessage = nullptr);
 }
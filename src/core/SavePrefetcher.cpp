@@ -0,0 +1,97 @@
+#include "core/SavePrefetcher.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QThread>
+#include <QtConcurrent>
+
+#include "core/LosslessJsonDocument.h"
+#include "core/SaveCache.h"
+
+SavePrefetcher::SavePrefetcher(QObject *parent)
+    : QObject(parent)
+{
+    pool_.setMaxThreadCount(1);
+    pool_.setThreadPriority(QThread::LowestPriority);
+}
+
+SavePrefetcher::~SavePrefetcher()
+{
+    cancel();
+    pool_.waitForDone();
+}
+
+void SavePrefetcher::prefetch(const QString &filePath)
+{
+    if (filePath == pendingPath_ && pending_.isRunning()) {
+        return;
+    }
+    cancel();
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    cancelled_ = cancelled;
+    pendingPath_ = filePath;
+    // Decoding itself cannot be interrupted, so cancellation is checked
+    // between the stages; a cancelled run stops before parsing the lossless tree.
+    pending_ = QtConcurrent::run(&pool_, [filePath, cancelled]() {
+        if (cancelled->load()) {
+            return;
+        }
+        // Holding no reference to the decoded text lets the lossless parse
+        // adopt the cache's copy.
+        if (!SaveCache::load(filePath, nullptr, nullptr) || cancelled->load()) {
+            return;
+        }
+        SaveCache::loadWithLossless(filePath, nullptr, nullptr);
+    });
+}
+
+void SavePrefetcher::installSaved(const QString &filePath, const QJsonDocument &doc,
+                                  const std::shared_ptr<LosslessJsonDocument> &lossless)
+{
+    const QFileInfo info(filePath);
+    if (!lossless || !info.exists()) {
+        return;
+    }
+    // Taken now, while they still describe what was written.
+    const QDateTime written = info.lastModified();
+    const qint64 size = info.size();
+    const quint64 generation = lossless->generation();
+    (void)QtConcurrent::run(&pool_, [filePath, doc, lossless, written, size, generation]() {
+        std::shared_ptr<LosslessJsonDocument> copy;
+        {
+            QReadLocker locker(lossless->lock());
+            if (lossless->generation() != generation) {
+                return;
+            }
+            copy = lossless->clone();
+        }
+        const QFileInfo current(filePath);
+        if (current.lastModified() != written || current.size() != size) {
+            return;
+        }
+        SaveCache::install(filePath, doc, copy);
+    });
+}
+
+void SavePrefetcher::cancel()
+{
+    if (cancelled_) {
+        cancelled_->store(true);
+        cancelled_.reset();
+    }
+    pendingPath_.clear();
+}
+
+QFuture<void> SavePrefetcher::pendingFor(const QString &filePath) const
+{
+    if (filePath.isEmpty() || filePath != pendingPath_) {
+        return QFuture<void>();
+    }
+    return pending_;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QFuture>
+#include <QJsonDocument>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+class LosslessJsonDocument;
+
+// Speculatively decodes a save into SaveCache on a low-priority thread so the
+// first editor opened for it finds the document already parsed.
+class SavePrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SavePrefetcher(QObject *parent = nullptr);
+    ~SavePrefetcher() override;
+
+    void prefetch(const QString &filePath);
+    // Copies lossless into SaveCache for the save just written to filePath.
+    // The copy is made on the prefetch thread and dropped if lossless is
+    // edited, or filePath rewritten, before it gets there.
+    void installSaved(const QString &filePath, const QJsonDocument &doc,
+                      const std::shared_ptr<LosslessJsonDocument> &lossless);
+    void cancel();
+    // The in-flight prefetch for filePath, or an already finished future.
+    QFuture<void> pendingFor(const QString &filePath) const;
+
+private:
+    QThreadPool pool_;
+    QString pendingPath_;
+    QFuture<void> pending_;
+    std::shared_ptr<std::atomic_bool> cancelled_;
+};
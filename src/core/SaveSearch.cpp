@@ -0,0 +1,299 @@
+#include "core/SaveSearch.h"
+
+#include "core/LosslessJsonDocument.h"
+
+#include <QByteArrayMatcher>
+#include <QObject>
+#include <QPromise>
+#include <QRegularExpression>
+#include <QStringMatcher>
+#include <QtConcurrent>
+
+#include <atomic>
+
+namespace {
+constexpr int kMinScanTasks = 64;
+constexpr int kMaxSplitDepth = 6;
+constexpr int kNodesPerLock = 4096;
+
+struct ScanTask {
+    const rapidjson::Value *value = nullptr;
+    QVariantList path;
+};
+
+// One per scan task so no matcher state is shared between threads.
+class ValueMatcher
+{
+public:
+    explicit ValueMatcher(const SaveSearchQuery &query)
+        : mode_(query.mode)
+        , caseSensitive_(query.caseSensitive)
+        , textMatcher_(query.text, query.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive)
+        , bytesMatcher_(query.text.toUtf8())
+    {
+        if (mode_ == SaveSearchQuery::Mode::Regex) {
+            regex_.setPattern(query.text);
+            if (!caseSensitive_) {
+                regex_.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+            }
+        } else if (mode_ == SaveSearchQuery::Mode::Number) {
+            const QString number = query.text.trimmed();
+            uintTarget_ = number.toULongLong(&hasUint_, 0);
+            intTarget_ = number.toLongLong(&hasInt_, 0);
+            doubleTarget_ = number.toDouble(&hasDouble_);
+        }
+    }
+
+    bool matches(const rapidjson::Value &value, QString *display) const
+    {
+        if (mode_ == SaveSearchQuery::Mode::Number) {
+            if (!value.IsNumber() || !matchesNumber(value)) {
+                return false;
+            }
+            if (value.IsDouble()) {
+                *display = QString::number(value.GetDouble(), 'g', 17);
+            } else if (value.IsInt64()) {
+                *display = QString::number(value.GetInt64());
+            } else {
+                *display = QString::number(value.GetUint64());
+            }
+            return true;
+        }
+        if (!value.IsString()) {
+            return false;
+        }
+        const char *bytes = value.GetString();
+        const qsizetype length = static_cast<qsizetype>(value.GetStringLength());
+        if (mode_ == SaveSearchQuery::Mode::Text && caseSensitive_) {
+            // Matching raw UTF-8 avoids decoding every string in the save.
+            if (bytesMatcher_.indexIn(bytes, length) < 0) {
+                return false;
+            }
+            *display = QString::fromUtf8(bytes, length);
+            return true;
+        }
+        QString text = QString::fromUtf8(bytes, length);
+        const bool hit = mode_ == SaveSearchQuery::Mode::Regex ? regex_.match(text).hasMatch()
+                                                                : textMatcher_.indexIn(text) >= 0;
+        if (hit) {
+            *display = text;
+        }
+        return hit;
+    }
+
+private:
+    bool matchesNumber(const rapidjson::Value &value) const
+    {
+        if (value.IsDouble()) {
+            return hasDouble_ && value.GetDouble() == doubleTarget_;
+        }
+        if (hasUint_ && value.IsUint64()) {
+            return value.GetUint64() == uintTarget_;
+        }
+        if (hasInt_ && value.IsInt64()) {
+            return value.GetInt64() == intTarget_;
+        }
+        return !hasInt_ && !hasUint_ && hasDouble_ && value.GetDouble() == doubleTarget_;
+    }
+
+    SaveSearchQuery::Mode mode_;
+    bool caseSensitive_;
+    QStringMatcher textMatcher_;
+    QByteArrayMatcher bytesMatcher_;
+    QRegularExpression regex_;
+    quint64 uintTarget_ = 0;
+    qint64 intTarget_ = 0;
+    double doubleTarget_ = 0.0;
+    bool hasUint_ = false;
+    bool hasInt_ = false;
+    bool hasDouble_ = false;
+};
+
+struct ScanState {
+    QPromise<SaveSearchHit> *promise = nullptr;
+    const LosslessJsonDocument *doc = nullptr;
+    quint64 generation = 0;
+    std::atomic_int hits{0};
+    std::atomic_bool stale{false};
+};
+
+// Held by one scan task; gives the read lock up every kNodesPerLock nodes so
+// an edit on the UI thread never waits out the whole scan.
+struct ScanLock {
+    explicit ScanLock(ScanState &state)
+        : locker(state.doc->lock())
+    {
+    }
+
+    QReadLocker locker;
+    int budget = kNodesPerLock;
+};
+
+// False once an edit has landed since the scan started; the node pointers the
+// scan holds may be gone by then, so it has to stop.
+bool stillCurrent(ScanState &state)
+{
+    if (state.stale.load() || state.doc->generation() != state.generation) {
+        state.stale.store(true);
+        return false;
+    }
+    return true;
+}
+
+bool reportHit(ScanState &state, const QVariantList &path, const QString &value)
+{
+    if (state.hits.fetch_add(1) >= SaveSearch::kMaxHits) {
+        return false;
+    }
+    state.promise->addResult(SaveSearchHit{path, value});
+    return true;
+}
+
+bool scanValue(const rapidjson::Value &value, QVariantList &path, const ValueMatcher &matcher,
+               ScanState &state, ScanLock &lock)
+{
+    if (state.promise->isCanceled() || state.hits.load() >= SaveSearch::kMaxHits) {
+        return false;
+    }
+    if (--lock.budget == 0) {
+        lock.budget = kNodesPerLock;
+        lock.locker.unlock();
+        lock.locker.relock();
+        if (!stillCurrent(state)) {
+            return false;
+        }
+    }
+    if (value.IsObject()) {
+        for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
+            path.append(QString::fromUtf8(it->name.GetString(),
+                                          static_cast<qsizetype>(it->name.GetStringLength())));
+            const bool keepGoing = scanValue(it->value, path, matcher, state, lock);
+            path.removeLast();
+            if (!keepGoing) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (value.IsArray()) {
+        for (rapidjson::SizeType i = 0; i < value.Size(); ++i) {
+            path.append(static_cast<int>(i));
+            const bool keepGoing = scanValue(value[i], path, matcher, state, lock);
+            path.removeLast();
+            if (!keepGoing) {
+                return false;
+            }
+        }
+        return true;
+    }
+    QString display;
+    if (matcher.matches(value, &display)) {
+        return reportHit(state, path, display);
+    }
+    return true;
+}
+
+// Breaks the document into enough subtrees to keep every core busy. Scalars
+// met on the way are left in as single-value tasks.
+QList<ScanTask> splitIntoTasks(const rapidjson::Value &root)
+{
+    QList<ScanTask> tasks;
+    tasks.append(ScanTask{&root, QVariantList()});
+    for (int depth = 0; depth < kMaxSplitDepth && tasks.size() < kMinScanTasks; ++depth) {
+        QList<ScanTask> next;
+        bool split = false;
+        for (const ScanTask &task : tasks) {
+            const rapidjson::Value &value = *task.value;
+            if (value.IsObject() && value.MemberCount() > 0) {
+                split = true;
+                for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
+                    QVariantList path = task.path;
+                    path.append(QString::fromUtf8(it->name.GetString(),
+                                                  static_cast<qsizetype>(it->name.GetStringLength())));
+                    next.append(ScanTask{&it->value, path});
+                }
+            } else if (value.IsArray() && value.Size() > 0) {
+                split = true;
+                for (rapidjson::SizeType i = 0; i < value.Size(); ++i) {
+                    QVariantList path = task.path;
+                    path.append(static_cast<int>(i));
+                    next.append(ScanTask{&value[i], path});
+                }
+            } else {
+                next.append(task);
+            }
+        }
+        tasks = next;
+        if (!split) {
+            break;
+        }
+    }
+    return tasks;
+}
+}
+
+namespace SaveSearch {
+bool validateQuery(const SaveSearchQuery &query, QString *errorMessage)
+{
+    if (query.text.trimmed().isEmpty()) {
+        if (errorMessage) {
+            *errorMessage = QObject::tr("Enter a value to search for.");
+        }
+        return false;
+    }
+    if (query.mode == SaveSearchQuery::Mode::Regex) {
+        QRegularExpression regex(query.text);
+        if (!regex.isValid()) {
+            if (errorMessage) {
+                *errorMessage = QObject::tr("Invalid regular expression: %1").arg(regex.errorString());
+            }
+            return false;
+        }
+    }
+    if (query.mode == SaveSearchQuery::Mode::Number) {
+        bool ok = false;
+        const QString number = query.text.trimmed();
+        number.toULongLong(&ok, 0);
+        if (!ok) {
+            number.toLongLong(&ok, 0);
+        }
+        if (!ok) {
+            number.toDouble(&ok);
+        }
+        if (!ok) {
+            if (errorMessage) {
+                *errorMessage = QObject::tr("\"%1\" is not a number.").arg(number);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+QFuture<SaveSearchHit> start(const std::shared_ptr<LosslessJsonDocument> &doc,
+                             const SaveSearchQuery &query)
+{
+    return QtConcurrent::run([doc, query](QPromise<SaveSearchHit> &promise) {
+        if (!doc) {
+            return;
+        }
+        ScanState state;
+        state.promise = &promise;
+        state.doc = doc.get();
+        QList<ScanTask> tasks;
+        {
+            QReadLocker locker(doc->lock());
+            state.generation = doc->generation();
+            tasks = splitIntoTasks(doc->root());
+        }
+        QtConcurrent::blockingMap(tasks, [&query, &state](ScanTask &task) {
+            ScanLock lock(state);
+            if (!stillCurrent(state)) {
+                return;
+            }
+            ValueMatcher matcher(query);
+            scanValue(*task.value, task.path, matcher, state, lock);
+        });
+    });
+}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QFuture>
+#include <QString>
+#include <QVariantList>
+#include <memory>
+
+class LosslessJsonDocument;
+
+struct SaveSearchQuery {
+    enum class Mode { Text, Regex, Number };
+
+    Mode mode = Mode::Text;
+    QString text;
+    bool caseSensitive = false;
+};
+
+struct SaveSearchHit {
+    QVariantList path;
+    QString value;
+};
+
+namespace SaveSearch {
+constexpr int kMaxHits = 5000;
+
+bool validateQuery(const SaveSearchQuery &query, QString *errorMessage = nullptr);
+// Scans every scalar of doc in parallel and streams matches as they are found.
+// Text and regex queries match string values; number queries match numeric
+// values exactly. Hits arrive in no particular order and stop at kMaxHits.
+// The scan holds doc's read lock only in short stretches and stops early if
+// doc is edited meanwhile.
+QFuture<SaveSearchHit> start(const std::shared_ptr<LosslessJsonDocument> &doc,
+                             const SaveSearchQuery &query);
+}
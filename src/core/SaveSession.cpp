@@ -0,0 +1,147 @@
+#include "core/SaveSession.h"
+
+#include "core/SaveJsonModel.h"
+
+namespace {
+constexpr int kMaxHistorySteps = 500;
+
+// Deepest path that contains every edit of a step.
+QVariantList commonPrefix(const QList<LosslessJsonDocument::Edit> &edits)
+{
+    QVariantList prefix = edits.first().path;
+    for (const LosslessJsonDocument::Edit &edit : edits) {
+        int shared = 0;
+        while (shared < prefix.size() && shared < edit.path.size()
+               && prefix.at(shared) == edit.path.at(shared)) {
+            ++shared;
+        }
+        prefix = prefix.mid(0, shared);
+    }
+    return prefix;
+}
+}
+
+SaveSession::SaveSession(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void SaveSession::reset(const QString &filePath, const QJsonDocument &doc,
+                        const std::shared_ptr<LosslessJsonDocument> &lossless)
+{
+    if (lossless_ && lossless_ != lossless) {
+        lossless_->setRecordingEdits(false);
+    }
+    filePath_ = filePath;
+    rootDoc_ = doc;
+    lossless_ = lossless;
+    if (lossless_) {
+        lossless_->setRecordingEdits(true);
+    }
+    dirty_ = false;
+    ++revision_;
+    undoSteps_.clear();
+    redoSteps_.clear();
+    emit sessionReset();
+    emit historyChanged();
+}
+
+void SaveSession::clear()
+{
+    if (!isLoaded()) {
+        return;
+    }
+    reset(QString(), QJsonDocument(), nullptr);
+}
+
+bool SaveSession::isLoaded() const
+{
+    return !filePath_.isEmpty() && lossless_ && !rootDoc_.isNull();
+}
+
+bool SaveSession::isLoadedFor(const QString &filePath) const
+{
+    return isLoaded() && filePath_ == filePath;
+}
+
+void SaveSession::notifyEdited(QObject *origin, const QVariantList &path)
+{
+    if (!isLoaded()) {
+        return;
+    }
+    // Every write since the last report belongs to this step, including ones
+    // made by other pages or open transactions, so the mirror is synced over
+    // all of them rather than only at the reporting page's path.
+    const QList<LosslessJsonDocument::Edit> edits = lossless_->takeEdits();
+    const QVariantList stepPath = edits.isEmpty() ? path : commonPrefix(edits);
+    if (edits.isEmpty()) {
+        SaveJsonModel::syncRootPathFromLossless(lossless_, rootDoc_, path);
+    } else {
+        syncMirror(stepPath);
+    }
+    dirty_ = true;
+    ++revision_;
+    if (!edits.isEmpty()) {
+        undoSteps_.append(HistoryStep{stepPath, edits});
+        if (undoSteps_.size() > kMaxHistorySteps) {
+            undoSteps_.removeFirst();
+        }
+        redoSteps_.clear();
+        emit historyChanged();
+    }
+    emit documentChanged(origin, stepPath);
+}
+
+bool SaveSession::undo()
+{
+    if (!isLoaded() || undoSteps_.isEmpty()) {
+        return false;
+    }
+    HistoryStep step = undoSteps_.takeLast();
+    for (int i = step.edits.size() - 1; i >= 0; --i) {
+        lossless_->applyEdit(step.edits[i]);
+    }
+    redoSteps_.append(step);
+    finishHistoryMove(step.path);
+    return true;
+}
+
+bool SaveSession::redo()
+{
+    if (!isLoaded() || redoSteps_.isEmpty()) {
+        return false;
+    }
+    HistoryStep step = redoSteps_.takeLast();
+    for (LosslessJsonDocument::Edit &edit : step.edits) {
+        lossless_->applyEdit(edit);
+    }
+    undoSteps_.append(step);
+    finishHistoryMove(step.path);
+    return true;
+}
+
+void SaveSession::finishHistoryMove(const QVariantList &path)
+{
+    syncMirror(path);
+    dirty_ = true;
+    ++revision_;
+    emit historyChanged();
+    emit documentChanged(this, path);
+}
+
+void SaveSession::syncMirror(const QVariantList &path)
+{
+    // Step paths come from recorded edits, so they are in the document's own
+    // keys. A step can add or remove the member at its path; sync the nearest
+    // container that still exists instead of falling back to the whole root.
+    QVariantList target = path;
+    while (!target.isEmpty() && !lossless_->valueAtPath(target)) {
+        target.removeLast();
+    }
+    SaveJsonModel::syncRootPathFromLossless(lossless_, rootDoc_, target);
+}
+
+void SaveSession::markSaved()
+{
+    dirty_ = false;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QJsonDocument>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QVariantList>
+#include <memory>
+
+#include "core/LosslessJsonDocument.h"
+
+// The one in-memory copy of the loaded save that every editor page views and
+// mutates. Pages report edits by path; the session keeps its Qt mirror in step
+// and tells the other subscribers which subtree changed. Each report becomes an
+// undo step holding only the lossless subtrees it replaced.
+class SaveSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SaveSession(QObject *parent = nullptr);
+
+    void reset(const QString &filePath, const QJsonDocument &doc,
+               const std::shared_ptr<LosslessJsonDocument> &lossless);
+    void clear();
+
+    bool isLoaded() const;
+    bool isLoadedFor(const QString &filePath) const;
+    const QString &filePath() const { return filePath_; }
+    const QJsonDocument &rootDoc() const { return rootDoc_; }
+    const std::shared_ptr<LosslessJsonDocument> &lossless() const { return lossless_; }
+    quint64 revision() const { return revision_; }
+    bool isDirty() const { return dirty_; }
+
+    void notifyEdited(QObject *origin, const QVariantList &path);
+    void markSaved();
+
+    bool canUndo() const { return !undoSteps_.isEmpty(); }
+    bool canRedo() const { return !redoSteps_.isEmpty(); }
+    // Both report the change with the session as origin.
+    bool undo();
+    bool redo();
+
+signals:
+    void documentChanged(QObject *origin, const QVariantList &path);
+    void sessionReset();
+    void historyChanged();
+
+private:
+    struct HistoryStep {
+        QVariantList path;
+        QList<LosslessJsonDocument::Edit> edits;
+    };
+
+    void finishHistoryMove(const QVariantList &path);
+    void syncMirror(const QVariantList &path);
+
+    QString filePath_;
+    QJsonDocument rootDoc_;
+    std::shared_ptr<LosslessJsonDocument> lossless_;
+    quint64 revision_ = 0;
+    bool dirty_ = false;
+    QList<HistoryStep> undoSteps_;
+    QList<HistoryStep> redoSteps_;
+};
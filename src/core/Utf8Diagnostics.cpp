@@ -310,3 +310,35 @@ QByteArray sanitizeJsonUtf8ForQt(const QByteArray &bytes, bool *didSanitize)
 
     return out;
 }
+
+QString decodeJsonUtf8ForQt(const char *data, int size)
+{
+    const QByteArray bytes = QByteArray::fromRawData(data, size);
+    int i = 0;
+    while (i < size) {
+        int seqLen = utf8SequenceLength(static_cast<unsigned char>(bytes.at(i)));
+        if (seqLen == 0 || !isValidUtf8Sequence(bytes, i, seqLen)) {
+            break;
+        }
+        i += seqLen;
+    }
+    if (i >= size) {
+        return QString::fromUtf8(data, size);
+    }
+
+    // Mirror sanitizeJsonUtf8ForQt: invalid bytes become the Latin-1 code point
+    // they would have been escaped to.
+    QString out = QString::fromUtf8(data, i);
+    while (i < size) {
+        unsigned char c = static_cast<unsigned char>(bytes.at(i));
+        int seqLen = utf8SequenceLength(c);
+        if (seqLen == 0 || !isValidUtf8Sequence(bytes, i, seqLen)) {
+            out.append(QChar(c));
+            ++i;
+            continue;
+        }
+        out.append(QString::fromUtf8(data + i, seqLen));
+        i += seqLen;
+    }
+    return out;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <QByteArray>
+#include <QString>
 
 void logJsonUtf8Error(const QByteArray &bytes, int offset);
 QByteArray sanitizeJsonUtf8ForQt(const QByteArray &bytes, bool *didSanitize = nullptr);
+QString decodeJsonUtf8ForQt(const char *data, int size);
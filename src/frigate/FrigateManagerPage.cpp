@@ -486,10 +486,9 @@ void FrigateManagerPage::buildUi()
 
 bool FrigateManagerPage::loadFromFile(const QString &filePath, QString *errorMessage)
 {
-    QByteArray contentBytes;
     QJsonDocument doc;
     std::shared_ptr<LosslessJsonDocument> lossless;
-    if (!SaveCache::loadWithLossless(filePath, &contentBytes, &doc, &lossless, errorMessage)) {
+    if (!SaveCache::loadWithLossless(filePath, &doc, &lossless, errorMessage)) {
         return false;
     }
     return loadFromPrepared(filePath, doc, lossless, errorMessage);
@@ -1039,8 +1038,9 @@ QJsonValue FrigateManagerPage::valueAtPath(const QJsonValue &root, const QVarian
 void FrigateManagerPage::applyValueAtPath(const QVariantList &path, const QJsonValue &value)
 {
     if (SaveJsonModel::setLosslessValue(losslessDoc_, path, value)) {
-        syncRootFromLossless();
+        SaveJsonModel::syncRootPathFromLossless(losslessDoc_, rootDoc_, path);
         hasUnsavedChanges_ = true;
+        emit documentEdited(path);
     }
 }
 
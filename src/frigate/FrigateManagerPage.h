@@ -36,6 +36,7 @@ public:
 
 signals:
     void statusMessage(const QString &message);
+    void documentEdited(const QVariantList &path);
 
 private slots:
     void onFrigateSelected(int index);
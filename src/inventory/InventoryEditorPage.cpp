@@ -1,5 +1,6 @@
 #include "inventory/InventoryEditorPage.h"
 
+#include "core/JsonPath.h"
 #include "core/SaveCache.h"
 #include "core/SaveEncoder.h"
 #include "core/ResourceLocator.h"
@@ -135,10 +136,9 @@ InventoryEditorPage::InventoryEditorPage(QWidget *parent, InventorySections sect
 
 bool InventoryEditorPage::loadFromFile(const QString &filePath, QString *errorMessage)
 {
-    QByteArray contentBytes;
     QJsonDocument doc;
     std::shared_ptr<LosslessJsonDocument> lossless;
-    if (!SaveCache::loadWithLossless(filePath, &contentBytes, &doc, &lossless, errorMessage)) {
+    if (!SaveCache::loadWithLossless(filePath, &doc, &lossless, errorMessage)) {
         return false;
     }
     return loadFromPrepared(filePath, doc, lossless, errorMessage);
@@ -159,7 +159,7 @@ bool InventoryEditorPage::loadFromPrepared(
     losslessDoc_ = losslessDoc;
     currentFilePath_ = filePath;
     hasUnsavedChanges_ = false;
-    if (!syncRootFromLossless(errorMessage)) {
+    if (rootDoc_.isNull() && !syncRootFromLossless(errorMessage)) {
         return false;
     }
     updateActiveContext();
@@ -321,14 +321,15 @@ void InventoryEditorPage::rebuildTabs()
         grid->setShowIds(showIds_);
         grid->setCommitHandler([this, desc](const QJsonArray &updatedSlots, const QJsonArray &updatedValid, const QJsonArray &updatedSpecial)
                                {
-            applyValueAtPath(desc.slotsPath, updatedSlots, true);
+            beginEdit();
+            applyValueAtPath(desc.slotsPath, updatedSlots);
             if (!desc.validPath.isEmpty()) {
-                applyValueAtPath(desc.validPath, updatedValid, true);
+                applyValueAtPath(desc.validPath, updatedValid);
             }
             if (!desc.specialSlotsPath.isEmpty()) {
-                applyValueAtPath(desc.specialSlotsPath, updatedSpecial, true);
+                applyValueAtPath(desc.specialSlotsPath, updatedSpecial);
             }
-            finalizeDeferredSync(); });
+            commitEdit(); });
         connect(grid, &InventoryGridWidget::statusMessage, this, &InventoryEditorPage::statusMessage);
 
         auto *scroll = new QScrollArea(this);
@@ -1044,23 +1045,7 @@ bool InventoryEditorPage::resolveFrigateCache(InventoryDescriptor &out) const
 
 QJsonValue InventoryEditorPage::valueAtPath(const QJsonValue &root, const QVariantList &path)
 {
-    QJsonValue result = root;
-    for (const QVariant &p : path)
-    {
-        if (result.isObject())
-        {
-            result = result.toObject().value(p.toString());
-        }
-        else if (result.isArray())
-        {
-            result = result.toArray().at(p.toInt());
-        }
-        else
-        {
-            return QJsonValue();
-        }
-    }
-    return result;
+    return JsonPath(path).resolve(root);
 }
 
 QJsonValue InventoryEditorPage::setValueAtPath(const QJsonValue &root, const QVariantList &path,
@@ -1092,7 +1077,7 @@ QJsonValue InventoryEditorPage::setValueAtPath(const QJsonValue &root, const QVa
     return root;
 }
 
-void InventoryEditorPage::applyValueAtPath(const QVariantList &path, const QJsonValue &value, bool deferSync)
+void InventoryEditorPage::applyValueAtPath(const QVariantList &path, const QJsonValue &value)
 {
     if (!losslessDoc_) {
         QJsonValue rootValue = rootDoc_.isObject() ? QJsonValue(rootDoc_.object())
@@ -1162,10 +1147,13 @@ void InventoryEditorPage::applyValueAtPath(const QVariantList &path, const QJson
         }
     }
 
-    if (!deferSync) {
-        SaveJsonModel::syncRootFromLossless(losslessDoc_, rootDoc_);
-    }
     hasUnsavedChanges_ = true;
+    if (editTransaction_.isActive()) {
+        editTransaction_.recordWrite(path);
+        return;
+    }
+    SaveJsonModel::syncRootPathFromLossless(losslessDoc_, rootDoc_, path);
+    emit documentEdited(path);
 }
 
 void InventoryEditorPage::applyDiffAtPath(const QVariantList &path, const QJsonValue &current,
@@ -1174,6 +1162,7 @@ void InventoryEditorPage::applyDiffAtPath(const QVariantList &path, const QJsonV
     if (current == updated) {
         return;
     }
+    beginEdit();
     if (current.isObject() && updated.isObject()) {
         QJsonObject currentObj = current.toObject();
         QJsonObject updatedObj = updated.toObject();
@@ -1181,29 +1170,30 @@ void InventoryEditorPage::applyDiffAtPath(const QVariantList &path, const QJsonV
             QJsonValue currentValue = currentObj.value(it.key());
             applyDiffAtPath(path + QVariantList{it.key()}, currentValue, it.value());
         }
-        return;
-    }
-    if (current.isArray() && updated.isArray()) {
+    } else if (current.isArray() && updated.isArray()
+               && current.toArray().size() == updated.toArray().size()) {
         QJsonArray currentArr = current.toArray();
         QJsonArray updatedArr = updated.toArray();
-        if (currentArr.size() != updatedArr.size()) {
-            applyValueAtPath(path, updated);
-            return;
-        }
         for (int i = 0; i < updatedArr.size(); ++i) {
             applyDiffAtPath(path + QVariantList{i}, currentArr.at(i), updatedArr.at(i));
         }
-        return;
+    } else {
+        applyValueAtPath(path, updated);
     }
-    applyValueAtPath(path, updated);
+    commitEdit();
 }
 
-void InventoryEditorPage::finalizeDeferredSync()
+void InventoryEditorPage::beginEdit()
 {
-    if (!losslessDoc_) {
-        return;
+    editTransaction_.begin();
+}
+
+void InventoryEditorPage::commitEdit()
+{
+    QVariantList changedPath;
+    if (editTransaction_.commit(losslessDoc_, rootDoc_, &changedPath)) {
+        emit documentEdited(changedPath);
     }
-    SaveJsonModel::syncRootFromLossless(losslessDoc_, rootDoc_);
 }
 
 QJsonObject InventoryEditorPage::activePlayerState() const
@@ -1908,11 +1898,12 @@ QWidget *InventoryEditorPage::buildStorageManager()
         grid->setShowIds(showIds_);
         grid->setCommitHandler([this, desc](const QJsonArray &updatedSlots, const QJsonArray &updatedValid, const QJsonArray &)
                                {
-            applyValueAtPath(desc.slotsPath, updatedSlots, true);
+            beginEdit();
+            applyValueAtPath(desc.slotsPath, updatedSlots);
             if (!desc.validPath.isEmpty()) {
-                applyValueAtPath(desc.validPath, updatedValid, true);
+                applyValueAtPath(desc.validPath, updatedValid);
             }
-            finalizeDeferredSync();
+            commitEdit();
         });
         connect(grid, &InventoryGridWidget::statusMessage, this, &InventoryEditorPage::statusMessage);
         auto *scroll = new QScrollArea(window);
@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "core/LosslessJsonDocument.h"
+#include "core/SaveEditTransaction.h"
 
 class QTabWidget;
 
@@ -51,6 +52,7 @@ public:
 
 signals:
     void statusMessage(const QString &message);
+    void documentEdited(const QVariantList &path);
 
 private:
     enum class InventoryType {
@@ -86,9 +88,10 @@ private:
     void addExpeditionTab();
     void addSettlementTab();
     void addStorageManagerTab();
-    void applyValueAtPath(const QVariantList &path, const QJsonValue &value, bool deferSync = false);
+    void applyValueAtPath(const QVariantList &path, const QJsonValue &value);
     void applyDiffAtPath(const QVariantList &path, const QJsonValue &current, const QJsonValue &updated);
-    void finalizeDeferredSync();
+    void beginEdit();
+    void commitEdit();
 
     QWidget *buildCurrencyRow(const QString &labelText, const QString &jsonKey,
                               const QString &iconId, const QVariantList &playerPath,
@@ -116,6 +119,7 @@ private:
     std::shared_ptr<LosslessJsonDocument> losslessDoc_;
     QString currentFilePath_;
     bool hasUnsavedChanges_ = false;
+    SaveEditTransaction editTransaction_;
     bool usingExpeditionContext_ = false;
     InventorySections sections_;
     bool showIds_ = false;
@@ -31,10 +31,9 @@ KnownProductPage::KnownProductPage(QWidget *parent)
 
 bool KnownProductPage::loadFromFile(const QString &filePath, QString *errorMessage)
 {
-    QByteArray contentBytes;
     QJsonDocument doc;
     std::shared_ptr<LosslessJsonDocument> lossless;
-    if (!SaveCache::loadWithLossless(filePath, &contentBytes, &doc, &lossless, errorMessage)) {
+    if (!SaveCache::loadWithLossless(filePath, &doc, &lossless, errorMessage)) {
         return false;
     }
     return loadFromPrepared(filePath, doc, lossless, errorMessage);
@@ -55,7 +54,7 @@ bool KnownProductPage::loadFromPrepared(
     losslessDoc_ = losslessDoc;
     currentFilePath_ = filePath;
     hasUnsavedChanges_ = false;
-    if (!syncRootFromLossless(errorMessage)) {
+    if (rootDoc_.isNull() && !syncRootFromLossless(errorMessage)) {
         return false;
     }
     updateActiveContext();
@@ -235,8 +234,9 @@ void KnownProductPage::applyValueAtPath(const QVariantList &path, const QJsonVal
         }
     }
 
-    SaveJsonModel::syncRootFromLossless(losslessDoc_, rootDoc_);
+    SaveJsonModel::syncRootPathFromLossless(losslessDoc_, rootDoc_, path);
     hasUnsavedChanges_ = true;
+    emit documentEdited(path);
 }
 
 bool KnownProductPage::syncRootFromLossless(QString *errorMessage)
@@ -30,10 +30,9 @@ KnownTechnologyPage::KnownTechnologyPage(QWidget *parent)
 
 bool KnownTechnologyPage::loadFromFile(const QString &filePath, QString *errorMessage)
 {
-    QByteArray contentBytes;
     QJsonDocument doc;
     std::shared_ptr<LosslessJsonDocument> lossless;
-    if (!SaveCache::loadWithLossless(filePath, &contentBytes, &doc, &lossless, errorMessage)) {
+    if (!SaveCache::loadWithLossless(filePath, &doc, &lossless, errorMessage)) {
         return false;
     }
     return loadFromPrepared(filePath, doc, lossless, errorMessage);
@@ -54,7 +53,7 @@ bool KnownTechnologyPage::loadFromPrepared(
     losslessDoc_ = losslessDoc;
     currentFilePath_ = filePath;
     hasUnsavedChanges_ = false;
-    if (!syncRootFromLossless(errorMessage)) {
+    if (rootDoc_.isNull() && !syncRootFromLossless(errorMessage)) {
         return false;
     }
     updateActiveContext();
@@ -234,8 +233,9 @@ void KnownTechnologyPage::applyValueAtPath(const QVariantList &path, const QJson
         }
     }
 
-    SaveJsonModel::syncRootFromLossless(losslessDoc_, rootDoc_);
+    SaveJsonModel::syncRootPathFromLossless(losslessDoc_, rootDoc_, path);
     hasUnsavedChanges_ = true;
+    emit documentEdited(path);
 }
 
 bool KnownTechnologyPage::syncRootFromLossless(QString *errorMessage)
@@ -28,6 +28,7 @@ public:
 
 signals:
     void statusMessage(const QString &message);
+    void documentEdited(const QVariantList &path);
 
 private:
     void updateActiveContext();
@@ -1,5 +1,6 @@
 #include "settlement/SettlementManagerPage.h"
 
+#include "core/JsonPath.h"
 #include "core/SaveCache.h"
 #include "core/SaveEncoder.h"
 #include "core/SaveJsonModel.h"
@@ -373,10 +374,9 @@ SettlementManagerPage::SettlementManagerPage(QWidget *parent)
 
 bool SettlementManagerPage::loadFromFile(const QString &filePath, QString *errorMessage)
 {
-    QByteArray contentBytes;
     QJsonDocument doc;
     std::shared_ptr<LosslessJsonDocument> lossless;
-    if (!SaveCache::loadWithLossless(filePath, &contentBytes, &doc, &lossless, errorMessage)) {
+    if (!SaveCache::loadWithLossless(filePath, &doc, &lossless, errorMessage)) {
         return false;
     }
     return loadFromPrepared(filePath, doc, lossless, errorMessage);
@@ -397,7 +397,7 @@ bool SettlementManagerPage::loadFromPrepared(
     losslessDoc_ = losslessDoc;
     currentFilePath_ = filePath;
     hasUnsavedChanges_ = false;
-    if (!syncRootFromLossless(errorMessage)) {
+    if (rootDoc_.isNull() && !syncRootFromLossless(errorMessage)) {
         return false;
     }
     updateActiveContext();
@@ -629,6 +629,7 @@ QWidget *SettlementManagerPage::buildSettlementForm(int index)
         {
             return;
         }
+        beginEdit();
         for (auto it = settlementObj.begin(); it != settlementObj.end(); ++it)
         {
             if (original.value(it.key()) != it.value())
@@ -636,6 +637,7 @@ QWidget *SettlementManagerPage::buildSettlementForm(int index)
                 applyValueAtPath(settlementPath + QVariantList{it.key()}, it.value());
             }
         }
+        commitEdit();
         emit statusMessage(tr("Pending changes — remember to Save!"));
     };
 
@@ -1435,31 +1437,7 @@ QJsonObject SettlementManagerPage::settlementAtIndex(int index) const
 
 QJsonValue SettlementManagerPage::valueAtPath(const QJsonValue &root, const QVariantList &path) const
 {
-    QJsonValue current = root;
-    for (const QVariant &segment : path)
-    {
-        if (segment.canConvert<int>() && current.isArray())
-        {
-            int index = segment.toInt();
-            QJsonArray array = current.toArray();
-            if (index < 0 || index >= array.size())
-            {
-                return QJsonValue();
-            }
-            current = array.at(index);
-        }
-        else if (segment.canConvert<QString>() && current.isObject())
-        {
-            QJsonObject obj = current.toObject();
-            QString key = segment.toString();
-            current = obj.value(key);
-        }
-        else
-        {
-            return QJsonValue();
-        }
-    }
-    return current;
+    return JsonPath(path).resolve(root);
 }
 
 QJsonValue SettlementManagerPage::setValueAtPath(const QJsonValue &root, const QVariantList &path,
@@ -1555,8 +1533,26 @@ void SettlementManagerPage::applyValueAtPath(const QVariantList &path, const QJs
         }
     }
 
-    SaveJsonModel::syncRootFromLossless(losslessDoc_, rootDoc_);
     hasUnsavedChanges_ = true;
+    if (editTransaction_.isActive()) {
+        editTransaction_.recordWrite(path);
+        return;
+    }
+    SaveJsonModel::syncRootPathFromLossless(losslessDoc_, rootDoc_, path);
+    emit documentEdited(path);
+}
+
+void SettlementManagerPage::beginEdit()
+{
+    editTransaction_.begin();
+}
+
+void SettlementManagerPage::commitEdit()
+{
+    QVariantList changedPath;
+    if (editTransaction_.commit(losslessDoc_, rootDoc_, &changedPath)) {
+        emit documentEdited(changedPath);
+    }
 }
 
 bool SettlementManagerPage::syncRootFromLossless(QString *errorMessage)
@@ -8,6 +8,7 @@
 #include <memory>
 
 #include "core/LosslessJsonDocument.h"
+#include "core/SaveEditTransaction.h"
 
 class QComboBox;
 class QScrollArea;
@@ -31,6 +32,7 @@ public:
 
 signals:
     void statusMessage(const QString &message);
+    void documentEdited(const QVariantList &path);
 
 private:
     struct SettlementEntry {
@@ -59,6 +61,8 @@ private:
     QJsonValue setValueAtPath(const QJsonValue &root, const QVariantList &path, int depth,
                               const QJsonValue &value) const;
     void applyValueAtPath(const QVariantList &path, const QJsonValue &value);
+    void beginEdit();
+    void commitEdit();
     bool syncRootFromLossless(QString *errorMessage = nullptr);
 
     QComboBox *settlementCombo_ = nullptr;
@@ -71,5 +75,6 @@ private:
     std::shared_ptr<LosslessJsonDocument> losslessDoc_;
     QString currentFilePath_;
     bool hasUnsavedChanges_ = false;
+    SaveEditTransaction editTransaction_;
     bool usingExpeditionContext_ = false;
 };
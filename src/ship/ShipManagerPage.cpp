@@ -1,6 +1,7 @@
 #include "ship/ShipManagerPage.h"
 
 #include "core/JsonMapper.h"
+#include "core/JsonPath.h"
 #include "core/LosslessJsonDocument.h"
 #include "core/ResourceLocator.h"
 #include "core/SaveCache.h"
@@ -438,10 +439,9 @@ ShipManagerPage::ShipManagerPage(QWidget *parent)
 
 bool ShipManagerPage::loadFromFile(const QString &filePath, QString *errorMessage)
 {
-    QByteArray contentBytes;
     QJsonDocument doc;
     std::shared_ptr<LosslessJsonDocument> lossless;
-    if (!SaveCache::loadWithLossless(filePath, &contentBytes, &doc, &lossless, errorMessage)) {
+    if (!SaveCache::loadWithLossless(filePath, &doc, &lossless, errorMessage)) {
         return false;
     }
     return loadFromPrepared(filePath, doc, lossless, errorMessage);
@@ -462,7 +462,7 @@ bool ShipManagerPage::loadFromPrepared(
     losslessDoc_ = losslessDoc;
     currentFilePath_ = filePath;
     hasUnsavedChanges_ = false;
-    if (!syncRootFromLossless(errorMessage)) {
+    if (rootDoc_.isNull() && !syncRootFromLossless(errorMessage)) {
         return false;
     }
     updateActiveContext();
@@ -913,11 +913,7 @@ void ShipManagerPage::importShip()
     }
 
     ensureMappingLoaded();
-    QHash<QString, QString> longToShort;
-    const auto mapping = JsonMapper::mapping();
-    for (auto it = mapping.begin(); it != mapping.end(); ++it) {
-        longToShort.insert(it.value(), it.key());
-    }
+    const QHash<QString, QString> &longToShort = JsonMapper::reverseMapping();
     QJsonObject sourceObject = root;
     if (root.contains(QStringLiteral("Ship")) && root.value(QStringLiteral("Ship")).isObject()) {
         sourceObject = root.value(QStringLiteral("Ship")).toObject();
@@ -1295,6 +1291,7 @@ void ShipManagerPage::updateContextResources(const QVariantList &contextPath,
     if (paths.isEmpty()) {
         return;
     }
+    beginEdit();
     for (const QVariantList &relative : paths) {
         QVariantList fullPath = contextPath;
         fullPath.append(relative);
@@ -1307,6 +1304,7 @@ void ShipManagerPage::updateContextResources(const QVariantList &contextPath,
             applyValueAtPath(fullPath, newResource);
         }
     }
+    commitEdit();
 }
 
 void ShipManagerPage::updateShipInventoryClass(QJsonObject &ship, const QString &value)
@@ -1349,23 +1347,7 @@ void ShipManagerPage::updateShipInventoryClass(QJsonObject &ship, const QString
 
 QJsonValue ShipManagerPage::valueAtPath(const QJsonValue &root, const QVariantList &path) const
 {
-    QJsonValue result = root;
-    for (const QVariant &segment : path)
-    {
-        if (result.isObject())
-        {
-            result = result.toObject().value(segment.toString());
-        }
-        else if (result.isArray())
-        {
-            result = result.toArray().at(segment.toInt());
-        }
-        else
-        {
-            return QJsonValue();
-        }
-    }
-    return result;
+    return JsonPath(path).resolve(root);
 }
 
 QJsonValue ShipManagerPage::setValueAtPath(const QJsonValue &root, const QVariantList &path, int depth,
@@ -1410,8 +1392,26 @@ void ShipManagerPage::applyValueAtPath(const QVariantList &path, const QJsonValu
     }
 
     SaveJsonModel::setLosslessValue(losslessDoc_, path, value);
-    SaveJsonModel::syncRootFromLossless(losslessDoc_, rootDoc_);
     hasUnsavedChanges_ = true;
+    if (editTransaction_.isActive()) {
+        editTransaction_.recordWrite(path);
+        return;
+    }
+    SaveJsonModel::syncRootPathFromLossless(losslessDoc_, rootDoc_, path);
+    emit documentEdited(path);
+}
+
+void ShipManagerPage::beginEdit()
+{
+    editTransaction_.begin();
+}
+
+void ShipManagerPage::commitEdit()
+{
+    QVariantList changedPath;
+    if (editTransaction_.commit(losslessDoc_, rootDoc_, &changedPath)) {
+        emit documentEdited(changedPath);
+    }
 }
 
 void ShipManagerPage::refreshShipFields(const QJsonObject &ship)
@@ -6,6 +6,8 @@
 #include <functional>
 #include <memory>
 
+#include "core/SaveEditTransaction.h"
+
 class QCheckBox;
 class QComboBox;
 class QLineEdit;
@@ -36,6 +38,7 @@ public:
 
 signals:
     void statusMessage(const QString &message);
+    void documentEdited(const QVariantList &path);
 
 private:
     void buildUi();
@@ -66,6 +69,8 @@ private:
     QJsonValue setValueAtPath(const QJsonValue &root, const QVariantList &path, int depth,
                               const QJsonValue &value) const;
     void applyValueAtPath(const QVariantList &path, const QJsonValue &value);
+    void beginEdit();
+    void commitEdit();
 
     void refreshShipFields(const QJsonObject &ship);
     QString shipNameFromObject(const QJsonObject &ship) const;
@@ -104,4 +109,5 @@ private:
     std::shared_ptr<LosslessJsonDocument> losslessDoc_;
     QString currentFilePath_;
     bool hasUnsavedChanges_ = false;
+    SaveEditTransaction editTransaction_;
 };
@@ -0,0 +1,104 @@
+#include "ui/BackupTableModel.h"
+
+namespace {
+QString displayPath(const BackupEntry &entry)
+{
+    return entry.inBlobStore ? entry.metadataPath : entry.backupPath;
+}
+}
+
+BackupTableModel::BackupTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void BackupTableModel::setBackups(const QList<BackupEntry> &entries)
+{
+    beginResetModel();
+    backups_ = entries;
+    endResetModel();
+}
+
+BackupEntry BackupTableModel::backupAt(int row) const
+{
+    if (row < 0 || row >= backups_.size()) {
+        return {};
+    }
+    return backups_.at(row);
+}
+
+int BackupTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : backups_.size();
+}
+
+int BackupTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant BackupTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= backups_.size()) {
+        return QVariant();
+    }
+    const BackupEntry &entry = backups_.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case ColumnTime:
+            return BackupManager::formatTimestamp(entry.backupTimeMs);
+        case ColumnSize:
+            return BackupManager::formatSize(entry.sizeBytes);
+        default:
+            return data(index, FilterRole);
+        }
+    case SortRole:
+        switch (index.column()) {
+        case ColumnTime:
+            return entry.backupTimeMs;
+        case ColumnSize:
+            return entry.sizeBytes;
+        default:
+            return data(index, FilterRole);
+        }
+    case FilterRole:
+        switch (index.column()) {
+        case ColumnSave:
+            return entry.saveName;
+        case ColumnSlot:
+            return entry.slotId;
+        case ColumnReason:
+            return entry.reason;
+        case ColumnPath:
+            return displayPath(entry);
+        default:
+            return QVariant();
+        }
+    default:
+        return QVariant();
+    }
+}
+
+QVariant BackupTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case ColumnTime:
+        return tr("Time");
+    case ColumnSave:
+        return tr("Save");
+    case ColumnSlot:
+        return tr("Slot");
+    case ColumnReason:
+        return tr("Reason");
+    case ColumnSize:
+        return tr("Size");
+    case ColumnPath:
+        return tr("Path");
+    default:
+        return QVariant();
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QList>
+
+#include "core/BackupManager.h"
+
+// Table over the backup list. Timestamps and sizes are formatted in data(),
+// so only the rows a view paints pay for it. SortRole gives the raw values
+// and FilterRole the text columns, for a proxy to sort and filter on.
+class BackupTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColumnTime,
+        ColumnSave,
+        ColumnSlot,
+        ColumnReason,
+        ColumnSize,
+        ColumnPath,
+        ColumnCount
+    };
+    static constexpr int SortRole = Qt::UserRole + 1;
+    static constexpr int FilterRole = Qt::UserRole + 2;
+
+    explicit BackupTableModel(QObject *parent = nullptr);
+
+    void setBackups(const QList<BackupEntry> &entries);
+    BackupEntry backupAt(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+private:
+    QList<BackupEntry> backups_;
+};
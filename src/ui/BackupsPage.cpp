@@ -5,22 +5,17 @@
 #include <QDesktopServices>
 #include <QHeaderView>
 #include <QHBoxLayout>
+#include <QItemSelectionModel>
 #include <QLabel>
+#include <QLineEdit>
 #include <QPushButton>
-#include <QTableWidget>
+#include <QSortFilterProxyModel>
+#include <QTableView>
 #include <QFileInfo>
 #include <QUrl>
 #include <QVBoxLayout>
 
-namespace {
-constexpr int kColumnTime = 0;
-constexpr int kColumnSave = 1;
-constexpr int kColumnSlot = 2;
-constexpr int kColumnReason = 3;
-constexpr int kColumnSize = 4;
-constexpr int kColumnPath = 5;
-constexpr int kColumnCount = 6;
-}
+#include "ui/BackupTableModel.h"
 
 BackupsPage::BackupsPage(QWidget *parent)
     : QWidget(parent)
@@ -39,40 +34,66 @@ BackupsPage::BackupsPage(QWidget *parent)
     auto *controls = new QHBoxLayout();
     currentOnly_ = new QCheckBox(tr("Only current save"), this);
     controls->addWidget(currentOnly_);
-    controls->addStretch(1);
+    filterEdit_ = new QLineEdit(this);
+    filterEdit_->setPlaceholderText(tr("Filter backups..."));
+    filterEdit_->setClearButtonEnabled(true);
+    controls->addWidget(filterEdit_, 1);
 
     refreshButton_ = new QPushButton(tr("Refresh"), this);
     controls->addWidget(refreshButton_);
+    rescanButton_ = new QPushButton(tr("Rescan Folder"), this);
+    controls->addWidget(rescanButton_);
+    pruneButton_ = new QPushButton(tr("Clean Up..."), this);
+    controls->addWidget(pruneButton_);
     layout->addLayout(controls);
 
-    table_ = new QTableWidget(this);
-    table_->setColumnCount(kColumnCount);
+    model_ = new BackupTableModel(this);
+    proxy_ = new QSortFilterProxyModel(this);
+    proxy_->setSourceModel(model_);
+    proxy_->setSortRole(BackupTableModel::SortRole);
+    proxy_->setFilterRole(BackupTableModel::FilterRole);
+    proxy_->setFilterKeyColumn(-1);
+    proxy_->setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+    // Fixed row heights and a header that only measures visible rows keep
+    // layout and painting proportional to the viewport, not the backup count.
+    table_ = new QTableView(this);
+    table_->setModel(proxy_);
     table_->setSelectionBehavior(QAbstractItemView::SelectRows);
     table_->setSelectionMode(QAbstractItemView::SingleSelection);
     table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    table_->setHorizontalHeaderLabels(QStringList()
-        << tr("Time") << tr("Save") << tr("Slot") << tr("Reason") << tr("Size") << tr("Path"));
+    table_->setWordWrap(false);
+    table_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    table_->horizontalHeader()->setResizeContentsPrecision(0);
     table_->horizontalHeader()->setStretchLastSection(true);
     table_->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table_->setSortingEnabled(true);
+    table_->sortByColumn(BackupTableModel::ColumnTime, Qt::DescendingOrder);
     layout->addWidget(table_, 1);
 
     auto *actions = new QHBoxLayout();
     actions->addStretch(1);
+    compareButton_ = new QPushButton(tr("Compare with Save"), this);
+    compareButton_->setEnabled(false);
+    actions->addWidget(compareButton_);
     restoreButton_ = new QPushButton(tr("Restore"), this);
     restoreButton_->setEnabled(false);
     actions->addWidget(restoreButton_);
     layout->addLayout(actions);
 
     connect(refreshButton_, &QPushButton::clicked, this, &BackupsPage::refreshRequested);
+    connect(rescanButton_, &QPushButton::clicked, this, &BackupsPage::rescanRequested);
+    connect(pruneButton_, &QPushButton::clicked, this, &BackupsPage::pruneRequested);
     connect(currentOnly_, &QCheckBox::toggled, this, &BackupsPage::refreshRequested);
-    connect(table_, &QTableWidget::itemSelectionChanged, this, [this]() {
-        restoreButton_->setEnabled(table_->currentRow() >= 0);
-    });
+    connect(filterEdit_, &QLineEdit::textChanged, proxy_, &QSortFilterProxyModel::setFilterFixedString);
+    connect(table_->selectionModel(), &QItemSelectionModel::selectionChanged, this, &BackupsPage::updateActions);
+    connect(proxy_, &QAbstractItemModel::modelReset, this, &BackupsPage::updateActions);
+    connect(proxy_, &QAbstractItemModel::layoutChanged, this, &BackupsPage::updateActions);
     connect(openFolderButton_, &QPushButton::clicked, this, [this]() {
         QString path = backupRoot_;
         BackupEntry entry = selectedBackup();
-        if (!entry.backupPath.isEmpty()) {
-            path = QFileInfo(entry.backupPath).absolutePath();
+        if (!entry.metadataPath.isEmpty()) {
+            path = QFileInfo(entry.metadataPath).absolutePath();
         }
         if (!path.isEmpty()) {
             emit openFolderRequested(path);
@@ -80,10 +101,16 @@ BackupsPage::BackupsPage(QWidget *parent)
     });
     connect(restoreButton_, &QPushButton::clicked, this, [this]() {
         BackupEntry entry = selectedBackup();
-        if (!entry.backupPath.isEmpty()) {
+        if (!entry.metadataPath.isEmpty()) {
             emit restoreRequested(entry);
         }
     });
+    connect(compareButton_, &QPushButton::clicked, this, [this]() {
+        BackupEntry entry = selectedBackup();
+        if (!entry.metadataPath.isEmpty()) {
+            emit compareRequested(entry);
+        }
+    });
 }
 
 void BackupsPage::setBackupRoot(const QString &path)
@@ -99,17 +126,16 @@ void BackupsPage::setCurrentSavePath(const QString &path)
 
 void BackupsPage::setBackups(const QList<BackupEntry> &entries)
 {
-    backups_ = entries;
-    rebuildTable();
+    model_->setBackups(entries);
 }
 
 BackupEntry BackupsPage::selectedBackup() const
 {
-    int row = table_->currentRow();
-    if (row < 0 || row >= backups_.size()) {
+    const QModelIndexList rows = table_->selectionModel()->selectedRows();
+    if (rows.isEmpty()) {
         return {};
     }
-    return backups_.at(row);
+    return model_->backupAt(proxy_->mapToSource(rows.first()).row());
 }
 
 bool BackupsPage::currentOnlyEnabled() const
@@ -117,25 +143,9 @@ bool BackupsPage::currentOnlyEnabled() const
     return currentOnly_->isChecked();
 }
 
-void BackupsPage::rebuildTable()
+void BackupsPage::updateActions()
 {
-    table_->setRowCount(backups_.size());
-    for (int row = 0; row < backups_.size(); ++row) {
-        const BackupEntry &entry = backups_.at(row);
-        auto *timeItem = new QTableWidgetItem(BackupManager::formatTimestamp(entry.backupTimeMs));
-        auto *saveItem = new QTableWidgetItem(entry.saveName);
-        auto *slotItem = new QTableWidgetItem(entry.slotId);
-        auto *reasonItem = new QTableWidgetItem(entry.reason);
-        auto *sizeItem = new QTableWidgetItem(BackupManager::formatSize(entry.sizeBytes));
-        auto *pathItem = new QTableWidgetItem(entry.backupPath);
-
-        table_->setItem(row, kColumnTime, timeItem);
-        table_->setItem(row, kColumnSave, saveItem);
-        table_->setItem(row, kColumnSlot, slotItem);
-        table_->setItem(row, kColumnReason, reasonItem);
-        table_->setItem(row, kColumnSize, sizeItem);
-        table_->setItem(row, kColumnPath, pathItem);
-    }
-    table_->resizeRowsToContents();
-    restoreButton_->setEnabled(table_->currentRow() >= 0);
+    const bool selected = table_->selectionModel()->hasSelection();
+    restoreButton_->setEnabled(selected);
+    compareButton_->setEnabled(selected);
 }
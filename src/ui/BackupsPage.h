@@ -4,10 +4,13 @@
 
 #include "core/BackupManager.h"
 
+class BackupTableModel;
 class QCheckBox;
 class QLabel;
+class QLineEdit;
 class QPushButton;
-class QTableWidget;
+class QSortFilterProxyModel;
+class QTableView;
 
 class BackupsPage : public QWidget
 {
@@ -24,19 +27,27 @@ public:
 
 signals:
     void refreshRequested();
+    void rescanRequested();
+    void pruneRequested();
     void restoreRequested(const BackupEntry &entry);
+    void compareRequested(const BackupEntry &entry);
     void openFolderRequested(const QString &path);
 
 private:
-    void rebuildTable();
+    void updateActions();
 
-    QList<BackupEntry> backups_;
     QString backupRoot_;
     QString currentSavePath_;
     QLabel *rootLabel_ = nullptr;
     QCheckBox *currentOnly_ = nullptr;
-    QTableWidget *table_ = nullptr;
+    QLineEdit *filterEdit_ = nullptr;
+    BackupTableModel *model_ = nullptr;
+    QSortFilterProxyModel *proxy_ = nullptr;
+    QTableView *table_ = nullptr;
     QPushButton *restoreButton_ = nullptr;
+    QPushButton *compareButton_ = nullptr;
     QPushButton *openFolderButton_ = nullptr;
     QPushButton *refreshButton_ = nullptr;
+    QPushButton *rescanButton_ = nullptr;
+    QPushButton *pruneButton_ = nullptr;
 };
@@ -5,6 +5,7 @@
 #include "core/SaveCache.h"
 #include "core/SaveEncoder.h"
 #include "core/SaveJsonModel.h"
+#include "ui/JsonTreeModel.h"
 
 #include <rapidjson/document.h>
 
@@ -14,6 +15,7 @@
 #include <QDialogButtonBox>
 #include <QDebug>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QFileInfo>
 #include <QFile>
 #include <QGroupBox>
@@ -29,20 +31,56 @@
 #include <QPushButton>
 #include <QRadioButton>
 #include <QRegularExpression>
+#include <QScrollBar>
 #include <QShortcut>
-#include <QStandardItem>
-#include <QStandardItemModel>
 #include <QSplitter>
+#include <QTableWidget>
 #include <QTextOption>
 #include <QTextCursor>
 #include <QTreeView>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 
 namespace {
-constexpr int kPathRole = Qt::UserRole + 1;
-constexpr int kModifiedRole = Qt::UserRole + 2;
-constexpr int kPopulatedRole = Qt::UserRole + 3;
 const char *kMappingFile = "mapping.json";
+constexpr int kSaveFindPathRole = Qt::UserRole + 1;
+// Values with more nodes than this are paged into a read-only editor.
+constexpr int kPagedEditorNodeThreshold = 20000;
+constexpr int kEditorPageBytes = 64 * 1024;
+
+bool exceedsNodeCount(const rapidjson::Value &value, int &budget)
+{
+    if (--budget < 0) {
+        return true;
+    }
+    if (value.IsObject()) {
+        for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
+            if (exceedsNodeCount(it->value, budget)) {
+                return true;
+            }
+        }
+    } else if (value.IsArray()) {
+        for (const rapidjson::Value &element : value.GetArray()) {
+            if (exceedsNodeCount(element, budget)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+QString readablePath(const QVariantList &path)
+{
+    QStringList parts;
+    for (const QVariant &segment : path) {
+        if (segment.typeId() == QMetaType::QString) {
+            parts << JsonMapper::mapKey(segment.toString());
+        } else {
+            parts << QString("[%1]").arg(segment.toInt());
+        }
+    }
+    return parts.join("/");
+}
 }
 
 JsonExplorerPage::JsonExplorerPage(QWidget *parent)
@@ -68,12 +106,49 @@ JsonExplorerPage::JsonExplorerPage(QWidget *parent)
     treeSearchLayout->addWidget(treeSearchField_);
     treeSearchLayout->addWidget(treeSearchPrevButton_);
     treeSearchLayout->addWidget(treeSearchNextButton_);
+    saveFindToggleButton_ = new QPushButton(tr("Find in Save"), treePane);
+    saveFindToggleButton_->setCheckable(true);
+    treeSearchLayout->addWidget(saveFindToggleButton_);
     treePaneLayout->addLayout(treeSearchLayout);
 
-    tree_ = new QTreeView(treePane);
+    auto *treeSplit = new QSplitter(Qt::Vertical, treePane);
+    treePaneLayout->addWidget(treeSplit);
+
+    tree_ = new QTreeView(treeSplit);
     tree_->setHeaderHidden(true);
     tree_->setContextMenuPolicy(Qt::CustomContextMenu);
-    treePaneLayout->addWidget(tree_);
+    treeSplit->addWidget(tree_);
+
+    saveFindPanel_ = new QWidget(treeSplit);
+    auto *saveFindLayout = new QVBoxLayout(saveFindPanel_);
+    saveFindLayout->setContentsMargins(0, 0, 0, 0);
+    auto *saveFindControls = new QHBoxLayout();
+    saveFindField_ = new QLineEdit(saveFindPanel_);
+    saveFindField_->setPlaceholderText(tr("Find values in save..."));
+    saveFindMode_ = new QComboBox(saveFindPanel_);
+    saveFindMode_->addItem(tr("Text"), static_cast<int>(SaveSearchQuery::Mode::Text));
+    saveFindMode_->addItem(tr("Regex"), static_cast<int>(SaveSearchQuery::Mode::Regex));
+    saveFindMode_->addItem(tr("Number"), static_cast<int>(SaveSearchQuery::Mode::Number));
+    saveFindCaseSensitive_ = new QCheckBox(tr("Case"), saveFindPanel_);
+    saveFindButton_ = new QPushButton(tr("Find"), saveFindPanel_);
+    saveFindControls->addWidget(saveFindField_, 1);
+    saveFindControls->addWidget(saveFindMode_);
+    saveFindControls->addWidget(saveFindCaseSensitive_);
+    saveFindControls->addWidget(saveFindButton_);
+    saveFindLayout->addLayout(saveFindControls);
+
+    saveFindResults_ = new QTableWidget(saveFindPanel_);
+    saveFindResults_->setColumnCount(2);
+    saveFindResults_->setSelectionBehavior(QAbstractItemView::SelectRows);
+    saveFindResults_->setSelectionMode(QAbstractItemView::SingleSelection);
+    saveFindResults_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    saveFindResults_->setHorizontalHeaderLabels(QStringList() << tr("Path") << tr("Value"));
+    saveFindResults_->horizontalHeader()->setStretchLastSection(true);
+    saveFindResults_->verticalHeader()->setVisible(false);
+    saveFindLayout->addWidget(saveFindResults_, 1);
+    treeSplit->addWidget(saveFindPanel_);
+    treeSplit->setStretchFactor(0, 1);
+    saveFindPanel_->setVisible(false);
 
     editor_ = new QPlainTextEdit(split);
     editor_->setWordWrapMode(QTextOption::NoWrap);
@@ -82,49 +157,60 @@ JsonExplorerPage::JsonExplorerPage(QWidget *parent)
     split->addWidget(editor_);
     split->setStretchFactor(1, 1);
 
-    model_ = new QStandardItemModel(this);
+    model_ = new JsonTreeModel(this);
     tree_->setModel(model_);
-    model_->appendRow(new QStandardItem(tr("Open a save file to begin.")));
+    model_->clear(tr("Open a save file to begin."));
     editor_->setPlainText(tr("// No save loaded."));
 
+    searchIndexWatcher_ = new QFutureWatcher<std::shared_ptr<JsonSearchIndex>>(this);
+    connect(searchIndexWatcher_, &QFutureWatcher<std::shared_ptr<JsonSearchIndex>>::finished, this, [this]() {
+        if (!losslessDoc_) {
+            return;
+        }
+        std::shared_ptr<JsonSearchIndex> index = searchIndexWatcher_->result();
+        // Edits made here while building are replayed below; any other change
+        // since the walk means the index is stale and is built again.
+        if (index->generation() != losslessDoc_->generation() && pendingIndexUpdates_.isEmpty()) {
+            startSearchIndexBuild();
+            return;
+        }
+        searchIndex_ = index;
+        for (const QVariantList &path : pendingIndexUpdates_) {
+            searchIndex_->update(*losslessDoc_, path);
+        }
+        pendingIndexUpdates_.clear();
+        treeSearchNeedle_.clear();
+    });
+
     connect(tree_->selectionModel(), &QItemSelectionModel::currentChanged, this,
             [this](const QModelIndex &current, const QModelIndex &) {
-                QStandardItem *item = model_->itemFromIndex(current);
-                if (!item) {
+                if (!current.isValid()) {
                     return;
                 }
-                qInfo() << "JsonExplorerPage selection changed to" << item->text();
-                if (currentItem_ && currentItem_ != item) {
+                qInfo() << "JsonExplorerPage selection changed to" << model_->label(current);
+                QPersistentModelIndex next(current);
+                if (currentIndex_.isValid() && currentIndex_ != next) {
                     commitEditor();
                 }
-                currentItem_ = item;
-                loadEditorForItem(item);
-                emit statusMessage(displayPath(item));
+                if (!next.isValid()) {
+                    return;
+                }
+                currentIndex_ = next;
+                currentPath_ = JsonPath(model_->pathForIndex(next));
+                loadEditorForIndex(next);
+                emit statusMessage(displayPath(next));
             });
 
-    connect(tree_, &QTreeView::expanded, this, [this](const QModelIndex &index) {
-        QStandardItem *item = model_->itemFromIndex(index);
-        if (!item) {
-            return;
-        }
-        if (item->data(kPopulatedRole).toBool()) {
-            return;
-        }
-        populateChildren(item);
-        item->setData(true, kPopulatedRole);
-    });
-
     connect(editor_, &QPlainTextEdit::textChanged, this, [this]() {
-        if (ignoreEditorChange_ || !currentItem_) {
+        if (ignoreEditorChange_ || !currentIndex_.isValid()) {
             return;
         }
-        QVariantList path = currentItem_->data(kPathRole).toList();
-        QJsonValue currentValue = valueAtPath(path);
+        QJsonValue currentValue = valueAtPath(currentPath_);
         QString expected = prettyPrinted(mapToReadable(currentValue));
         if (editor_->toPlainText() == expected) {
-            clearModified(currentItem_);
+            clearModified(currentIndex_);
         } else {
-            markModified(currentItem_);
+            markModified(currentIndex_);
         }
     });
 
@@ -133,22 +219,19 @@ JsonExplorerPage::JsonExplorerPage(QWidget *parent)
         if (!index.isValid()) {
             return;
         }
-        QStandardItem *item = model_->itemFromIndex(index);
-        if (!item) {
-            return;
-        }
         QMenu menu(this);
         QAction *revert = menu.addAction(tr("Undo Change"));
-        revert->setEnabled(modifiedItems_.contains(item));
+        revert->setEnabled(model_->isModified(index));
         QAction *selected = menu.exec(tree_->viewport()->mapToGlobal(pos));
         if (selected == revert) {
-            QVariantList path = item->data(kPathRole).toList();
+            QPersistentModelIndex item(index);
+            QVariantList path = model_->pathForIndex(item);
             QString key = pathKey(path);
             QJsonValue original = originalValues_.value(key);
             if (!original.isUndefined()) {
                 if (losslessDoc_) {
                     SaveJsonModel::setLosslessValue(losslessDoc_, path, original);
-                    SaveJsonModel::syncRootFromLossless(losslessDoc_, rootDoc_);
+                    SaveJsonModel::syncRootPathFromLossless(losslessDoc_, rootDoc_, path);
                 } else {
                     QJsonValue rootValue = rootDoc_.isObject() ? QJsonValue(rootDoc_.object())
                                                               : QJsonValue(rootDoc_.array());
@@ -159,16 +242,65 @@ JsonExplorerPage::JsonExplorerPage(QWidget *parent)
                         rootDoc_.setArray(updated.toArray());
                     }
                 }
+                model_->refresh(item);
+                updateSearchIndex(path);
                 clearModified(item);
-                loadEditorForItem(item);
+                loadEditorForIndex(item);
+                emit documentEdited(path);
                 emit statusMessage(tr("Reverted node."));
             }
         }
     });
 
+    connect(editor_->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        QScrollBar *bar = editor_->verticalScrollBar();
+        if (editorPager_ && !editorPager_->atEnd() && value >= bar->maximum() - bar->pageStep()) {
+            appendEditorPage();
+        }
+    });
+
     auto *findShortcut = new QShortcut(QKeySequence::Find, editor_);
     connect(findShortcut, &QShortcut::activated, this, &JsonExplorerPage::showFindDialog);
 
+    auto *saveFindShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F), this);
+    connect(saveFindShortcut, &QShortcut::activated, this, &JsonExplorerPage::showSaveFindPanel);
+    connect(saveFindToggleButton_, &QPushButton::toggled, this, [this](bool checked) {
+        saveFindPanel_->setVisible(checked);
+        if (checked) {
+            saveFindField_->setFocus();
+        }
+    });
+    connect(saveFindField_, &QLineEdit::returnPressed, this, &JsonExplorerPage::startSaveFind);
+    connect(saveFindButton_, &QPushButton::clicked, this, [this]() {
+        if (saveFindWatcher_->isRunning()) {
+            stopSaveFind();
+        } else {
+            startSaveFind();
+        }
+    });
+    connect(saveFindResults_, &QTableWidget::cellClicked, this, [this](int row, int) {
+        QTableWidgetItem *item = saveFindResults_->item(row, 0);
+        if (item && !selectPath(item->data(kSaveFindPathRole).toList())) {
+            emit statusMessage(tr("Node no longer exists."));
+        }
+    });
+
+    saveFindWatcher_ = new QFutureWatcher<SaveSearchHit>(this);
+    connect(saveFindWatcher_, &QFutureWatcher<SaveSearchHit>::resultsReadyAt, this,
+            &JsonExplorerPage::appendSaveFindResults);
+    connect(saveFindWatcher_, &QFutureWatcher<SaveSearchHit>::finished, this, [this]() {
+        saveFindButton_->setText(tr("Find"));
+        const int count = saveFindResults_->rowCount();
+        if (losslessDoc_ && losslessDoc_->generation() != saveFindGeneration_) {
+            emit statusMessage(tr("The save changed during the search; %n match(es) found before it stopped.",
+                                  nullptr, count));
+        } else if (count >= SaveSearch::kMaxHits) {
+            emit statusMessage(tr("Showing the first %1 matches.").arg(count));
+        } else {
+            emit statusMessage(tr("%n match(es) in save.", nullptr, count));
+        }
+    });
+
     connect(treeSearchField_, &QLineEdit::returnPressed, this, [this]() {
         performTreeSearch(false);
     });
@@ -187,8 +319,8 @@ void JsonExplorerPage::setRootDoc(const QJsonDocument &doc, const QString &fileP
     rootDoc_ = doc;
     currentFilePath_ = filePath;
     losslessDoc_ = losslessDoc;
-    modifiedItems_.clear();
     originalValues_.clear();
+    originalHashes_.clear();
     buildTree();
     emit statusMessage(tr("Loaded %1").arg(QFileInfo(filePath).fileName()));
 }
@@ -199,13 +331,11 @@ bool JsonExplorerPage::loadFromFile(const QString &filePath, QString *errorMessa
     ensureMappingLoaded();
     currentFilePath_.clear();
 
-    QByteArray contentBytes;
     QJsonDocument doc;
     std::shared_ptr<LosslessJsonDocument> lossless;
-    if (!SaveCache::loadWithLossless(filePath, &contentBytes, &doc, &lossless, errorMessage)) {
+    if (!SaveCache::loadWithLossless(filePath, &doc, &lossless, errorMessage)) {
         return false;
     }
-    qInfo() << "Loaded raw content length:" << contentBytes.size();
     if (!lossless) {
         if (errorMessage) {
             *errorMessage = tr("Failed to load lossless JSON.");
@@ -220,8 +350,8 @@ bool JsonExplorerPage::loadFromFile(const QString &filePath, QString *errorMessa
     if (!syncRootFromLossless(errorMessage)) {
         return false;
     }
-    modifiedItems_.clear();
     originalValues_.clear();
+    originalHashes_.clear();
     qInfo() << "Building JSON tree.";
     buildTree();
     qInfo() << "JSON tree built.";
@@ -276,10 +406,7 @@ bool JsonExplorerPage::saveChanges(QString *errorMessage)
         }
     }
 
-    for (QStandardItem *item : modifiedItems_) {
-        clearModified(item);
-    }
-    modifiedItems_.clear();
+    model_->clearModified();
     emit statusMessage(tr("Save complete."));
     return true;
 }
@@ -317,13 +444,27 @@ bool JsonExplorerPage::exportJson(const QString &filePath, QString *errorMessage
         }
         return false;
     }
+    if (editorPager_) {
+        // The editor only holds the pages viewed so far; stream the whole value.
+        JsonPrettyPager pager(losslessDoc_, editorPager_->path());
+        while (!pager.atEnd()) {
+            file.write(pager.nextChunk(kEditorPageBytes));
+        }
+        if (pager.isStale()) {
+            if (errorMessage) {
+                *errorMessage = tr("The save changed while exporting; export again.");
+            }
+            return false;
+        }
+        return true;
+    }
     file.write(editor_->toPlainText().toUtf8());
     return true;
 }
 
 bool JsonExplorerPage::hasUnsavedChanges() const
 {
-    return !modifiedItems_.isEmpty();
+    return model_->hasModified();
 }
 
 void JsonExplorerPage::clearLoadedSave()
@@ -331,15 +472,20 @@ void JsonExplorerPage::clearLoadedSave()
     currentFilePath_.clear();
     rootDoc_ = QJsonDocument();
     losslessDoc_.reset();
-    modifiedItems_.clear();
     originalValues_.clear();
-    reverseMapping_.clear();
-    currentItem_ = nullptr;
+    originalHashes_.clear();
+    searchIndex_.reset();
+    pendingIndexUpdates_.clear();
+    treeSearchNeedle_.clear();
+    stopSaveFind();
+    saveFindResults_->setRowCount(0);
+    currentIndex_ = QPersistentModelIndex();
+    currentPath_ = JsonPath();
+    editorPager_.reset();
     if (tree_->selectionModel()) {
         tree_->selectionModel()->clearSelection();
     }
-    model_->clear();
-    model_->appendRow(new QStandardItem(tr("Open a save file to begin.")));
+    model_->clear(tr("Open a save file to begin."));
     if (treeSearchField_) {
         treeSearchField_->clear();
     }
@@ -359,174 +505,37 @@ void JsonExplorerPage::collapseAll()
 void JsonExplorerPage::buildTree()
 {
     qInfo() << "JsonExplorerPage::buildTree start.";
-    currentItem_ = nullptr;
+    currentIndex_ = QPersistentModelIndex();
+    currentPath_ = JsonPath();
     if (tree_->selectionModel()) {
         tree_->selectionModel()->clearSelection();
     }
-    model_->clear();
     originalValues_.clear();
+    originalHashes_.clear();
 
-    QString rootLabel = QFileInfo(currentFilePath_).fileName();
-    QStandardItem *rootItem = new QStandardItem(rootLabel);
-    model_->appendRow(rootItem);
-
-    QVariantList rootPath;
-    QJsonValue rootValue = rootDoc_.isObject() ? QJsonValue(rootDoc_.object())
-                                               : QJsonValue(rootDoc_.array());
-    rootItem->setData(rootPath, kPathRole);
-    rootItem->setData(false, kPopulatedRole);
-    originalValues_.insert(pathKey(rootPath), rootValue);
-    addPlaceholderIfNeeded(rootItem, rootValue);
+    if (losslessDoc_) {
+        model_->setDocument(losslessDoc_, QFileInfo(currentFilePath_).fileName());
+        startSearchIndexBuild();
+        stopSaveFind();
+        saveFindResults_->setRowCount(0);
+    } else {
+        model_->clear(tr("Failed to load lossless JSON."));
+    }
 
     tree_->expandToDepth(0);
-    tree_->setCurrentIndex(rootItem->index());
+    tree_->setCurrentIndex(model_->rootIndex());
     qInfo() << "JsonExplorerPage::buildTree done.";
 }
 
-void JsonExplorerPage::populateChildren(QStandardItem *parent)
-{
-    if (!parent) {
-        return;
-    }
-    QVariantList path = parent->data(kPathRole).toList();
-    const rapidjson::Value *losslessValue = losslessValueAtPath(path);
-    if (losslessValue) {
-        parent->removeRows(0, parent->rowCount());
-
-        if (losslessValue->IsObject()) {
-            for (auto it = losslessValue->MemberBegin(); it != losslessValue->MemberEnd(); ++it) {
-                QString key = QString::fromUtf8(it->name.GetString(),
-                                                static_cast<int>(it->name.GetStringLength()));
-                QString mapped = JsonMapper::mapKey(key);
-                QVariantList childPath = path;
-                childPath.append(key);
-                QStandardItem *child = new QStandardItem(mapped);
-                child->setData(childPath, kPathRole);
-                child->setData(false, kPopulatedRole);
-                parent->appendRow(child);
-                originalValues_.insert(pathKey(childPath), valueAtPath(childPath));
-                if (it->value.IsObject() || it->value.IsArray()) {
-                    child->appendRow(new QStandardItem(tr("Loading...")));
-                }
-            }
-            return;
-        }
-        if (losslessValue->IsArray()) {
-            for (rapidjson::SizeType i = 0; i < losslessValue->Size(); ++i) {
-                QVariantList childPath = path;
-                childPath.append(static_cast<int>(i));
-                QStandardItem *child = new QStandardItem(QString("[%1]").arg(i));
-                child->setData(childPath, kPathRole);
-                child->setData(false, kPopulatedRole);
-                parent->appendRow(child);
-                originalValues_.insert(pathKey(childPath), valueAtPath(childPath));
-                const rapidjson::Value &element = (*losslessValue)[i];
-                if (element.IsObject() || element.IsArray()) {
-                    child->appendRow(new QStandardItem(tr("Loading...")));
-                }
-            }
-            return;
-        }
-    }
-
-    QJsonValue value = valueAtPath(path);
-    parent->removeRows(0, parent->rowCount());
-
-    if (value.isObject()) {
-        QJsonObject obj = value.toObject();
-        for (auto it = obj.begin(); it != obj.end(); ++it) {
-            QString mapped = JsonMapper::mapKey(it.key());
-            QVariantList childPath = path;
-            childPath.append(it.key());
-            QStandardItem *child = new QStandardItem(mapped);
-            child->setData(childPath, kPathRole);
-            child->setData(false, kPopulatedRole);
-            parent->appendRow(child);
-            originalValues_.insert(pathKey(childPath), it.value());
-            addPlaceholderIfNeeded(child, it.value());
-        }
-    } else if (value.isArray()) {
-        QJsonArray array = value.toArray();
-        for (int i = 0; i < array.size(); ++i) {
-            QVariantList childPath = path;
-            childPath.append(i);
-            QStandardItem *child = new QStandardItem(QString("[%1]").arg(i));
-            child->setData(childPath, kPathRole);
-            child->setData(false, kPopulatedRole);
-            parent->appendRow(child);
-            QJsonValue element = array.at(i);
-            originalValues_.insert(pathKey(childPath), element);
-            addPlaceholderIfNeeded(child, element);
-        }
-    }
-}
-
-const rapidjson::Value *JsonExplorerPage::losslessValueAtPath(const QVariantList &path) const
-{
-    if (!losslessDoc_) {
-        return nullptr;
-    }
-    const rapidjson::Value *node = &losslessDoc_->root();
-    for (const QVariant &segment : path) {
-        if (segment.canConvert<int>()) {
-            if (!node->IsArray()) {
-                return nullptr;
-            }
-            int index = segment.toInt();
-            if (index < 0 || index >= static_cast<int>(node->Size())) {
-                return nullptr;
-            }
-            node = &(*node)[static_cast<rapidjson::SizeType>(index)];
-            continue;
-        }
-        if (segment.canConvert<QString>()) {
-            if (!node->IsObject()) {
-                return nullptr;
-            }
-            QByteArray key = segment.toString().toUtf8();
-            auto it = node->FindMember(key.constData());
-            if (it == node->MemberEnd()) {
-                return nullptr;
-            }
-            node = &it->value;
-            continue;
-        }
-        return nullptr;
-    }
-    return node;
-}
-
-void JsonExplorerPage::addPlaceholderIfNeeded(QStandardItem *item, const QJsonValue &value)
+QJsonValue JsonExplorerPage::valueAtPath(const QVariantList &path) const
 {
-    if (!item) {
-        return;
-    }
-    if (value.isObject() || value.isArray()) {
-        item->appendRow(new QStandardItem(tr("Loading...")));
-    }
+    return valueAtPath(JsonPath(path));
 }
 
-QJsonValue JsonExplorerPage::valueAtPath(const QVariantList &path) const
+QJsonValue JsonExplorerPage::valueAtPath(const JsonPath &path) const
 {
-    QJsonValue current = rootDoc_.isObject() ? QJsonValue(rootDoc_.object())
-                                             : QJsonValue(rootDoc_.array());
-    for (const QVariant &segment : path) {
-        if (segment.canConvert<int>() && current.isArray()) {
-            QJsonArray array = current.toArray();
-            int index = segment.toInt();
-            if (index < 0 || index >= array.size()) {
-                return QJsonValue();
-            }
-            current = array.at(index);
-        } else if (segment.canConvert<QString>() && current.isObject()) {
-            QJsonObject obj = current.toObject();
-            QString key = segment.toString();
-            current = obj.value(key);
-        } else {
-            return QJsonValue();
-        }
-    }
-    return current;
+    return path.resolve(rootDoc_.isObject() ? QJsonValue(rootDoc_.object())
+                                            : QJsonValue(rootDoc_.array()));
 }
 
 QJsonValue JsonExplorerPage::remapToShort(const QJsonValue &value) const
@@ -588,7 +597,7 @@ QJsonValue JsonExplorerPage::remapToShort(const QJsonValue &value) const
 
             QString srcKey = stack[topIdx].keys.at(stack[topIdx].idx);
             QJsonValue srcVal = stack[topIdx].srcObj.value(srcKey);
-            QString shortKey = reverseMapping_.value(srcKey, srcKey);
+            QString shortKey = JsonMapper::unmapKey(srcKey);
             stack[topIdx].idx++;
 
             if (srcVal.isObject() || srcVal.isArray()) {
@@ -759,45 +768,71 @@ QString JsonExplorerPage::pathKey(const QVariantList &path) const
     return parts.join("/");
 }
 
-QString JsonExplorerPage::displayPath(QStandardItem *item) const
+QString JsonExplorerPage::displayPath(const QModelIndex &index) const
 {
-    if (!item) {
-        return QString();
-    }
     QStringList parts;
-    QStandardItem *current = item;
-    while (current) {
-        QString label = current->text();
-        if (label.endsWith('*')) {
-            label.chop(1);
-        }
-        parts.prepend(label);
-        current = current->parent();
+    QModelIndex current = index;
+    while (current.isValid()) {
+        parts.prepend(model_->label(current));
+        current = current.parent();
     }
     return parts.join("/");
 }
 
-void JsonExplorerPage::loadEditorForItem(QStandardItem *item)
+void JsonExplorerPage::loadEditorForIndex(const QModelIndex &index)
 {
-    if (!item) {
+    if (!index.isValid()) {
         return;
     }
-    QVariantList path = item->data(kPathRole).toList();
+    const rapidjson::Value *lossless = model_->valueForIndex(index);
+    int budget = kPagedEditorNodeThreshold;
+    if (lossless && exceedsNodeCount(*lossless, budget)) {
+        ignoreEditorChange_ = true;
+        editorPager_ = std::make_unique<JsonPrettyPager>(losslessDoc_, JsonPath(model_->pathForIndex(index)));
+        editor_->setReadOnly(true);
+        editor_->clear();
+        ignoreEditorChange_ = false;
+        appendEditorPage();
+        return;
+    }
+    editorPager_.reset();
+
+    QVariantList path = model_->pathForIndex(index);
     QJsonValue value = valueAtPath(path);
     
     ignoreEditorChange_ = true;
     editor_->setReadOnly(false);
     QString text = prettyPrinted(mapToReadable(value));
     if (text.isEmpty() && !value.isNull() && !value.isUndefined()) {
-        qWarning() << "JsonExplorerPage::loadEditorForItem: prettyPrinted returned empty for non-null value at" << path;
+        qWarning() << "JsonExplorerPage::loadEditorForIndex: prettyPrinted returned empty for non-null value at" << path;
     }
     editor_->setPlainText(text);
     ignoreEditorChange_ = false;
 }
 
+void JsonExplorerPage::appendEditorPage()
+{
+    if (!editorPager_ || editorPager_->atEnd()) {
+        return;
+    }
+    const QByteArray chunk = editorPager_->nextChunk(kEditorPageBytes);
+    if (editorPager_->isStale()) {
+        // The document was edited since paging started; show the node afresh.
+        if (currentIndex_.isValid()) {
+            loadEditorForIndex(currentIndex_);
+        }
+        return;
+    }
+    ignoreEditorChange_ = true;
+    QTextCursor cursor(editor_->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(QString::fromUtf8(chunk));
+    ignoreEditorChange_ = false;
+}
+
 bool JsonExplorerPage::commitEditor()
 {
-    if (!currentItem_ || !modifiedItems_.contains(currentItem_)) {
+    if (!currentIndex_.isValid() || !model_->isModified(currentIndex_)) {
         return false;
     }
 
@@ -806,11 +841,6 @@ bool JsonExplorerPage::commitEditor()
         return false;
     }
 
-    if (model_->itemFromIndex(currentItem_->index()) != currentItem_) {
-        qWarning() << "JsonExplorerPage::commitEditor current item no longer valid.";
-        return false;
-    }
-
     QString text = editor_->toPlainText().trimmed();
     if (text.isEmpty()) {
         return false;
@@ -836,17 +866,22 @@ bool JsonExplorerPage::commitEditor()
     }
 
     QJsonValue remapped = remapToShort(newValue);
-    QVariantList path = currentItem_->data(kPathRole).toList();
-    QJsonValue currentValue = valueAtPath(path);
-
-    if (currentValue == remapped) {
-        clearModified(currentItem_);
+    const QVariantList path = currentPath_.toVariantList();
+    const quint64 newHash = LosslessJsonDocument::hashValue(remapped);
+
+    // A differing hash proves the edit changed something without materialising
+    // the node; a matching one still has to be confirmed value by value.
+    const rapidjson::Value *currentNode = losslessDoc_ ? losslessDoc_->valueAtPath(currentPath_) : nullptr;
+    const bool unchanged = (!currentNode || losslessDoc_->hash(*currentNode) == newHash)
+                           && valueAtPath(currentPath_) == remapped;
+    if (unchanged) {
+        clearModified(currentIndex_);
         return true;
     }
 
     if (losslessDoc_) {
-        SaveJsonModel::setLosslessValue(losslessDoc_, path, remapped);
-        SaveJsonModel::syncRootFromLossless(losslessDoc_, rootDoc_);
+        SaveJsonModel::setLosslessValue(losslessDoc_, currentPath_, remapped);
+        SaveJsonModel::syncRootPathFromLossless(losslessDoc_, rootDoc_, path);
     } else {
         QJsonValue rootValue = rootDoc_.isObject() ? QJsonValue(rootDoc_.object())
                                                    : QJsonValue(rootDoc_.array());
@@ -858,34 +893,41 @@ bool JsonExplorerPage::commitEditor()
         }
     }
 
-    markModified(currentItem_);
+    model_->refresh(currentIndex_);
+    updateSearchIndex(path);
+    const QString key = pathKey(path);
+    auto original = originalHashes_.constFind(key);
+    if (original != originalHashes_.constEnd() && original.value() == newHash
+        && originalValues_.value(key) == remapped) {
+        clearModified(currentIndex_);
+    } else {
+        markModified(currentIndex_);
+    }
+    emit documentEdited(path);
     return true;
 }
 
-void JsonExplorerPage::markModified(QStandardItem *item)
+void JsonExplorerPage::markModified(const QModelIndex &index)
 {
-    if (!item) {
+    if (!index.isValid() || model_->isModified(index)) {
         return;
     }
-    if (!modifiedItems_.contains(item)) {
-        modifiedItems_.insert(item);
-        QString text = item->text();
-        if (!text.endsWith('*')) {
-            item->setText(text + '*');
+    // Originals are captured on first edit rather than while browsing.
+    QVariantList path = model_->pathForIndex(index);
+    QString key = pathKey(path);
+    if (!originalValues_.contains(key)) {
+        originalValues_.insert(key, valueAtPath(path));
+        quint64 hash = 0;
+        if (losslessDoc_ && losslessDoc_->hashAtPath(path, &hash)) {
+            originalHashes_.insert(key, hash);
         }
     }
+    model_->setModified(index, true);
 }
 
-void JsonExplorerPage::clearModified(QStandardItem *item)
+void JsonExplorerPage::clearModified(const QModelIndex &index)
 {
-    if (!item) {
-        return;
-    }
-    QString text = item->text();
-    if (text.endsWith('*')) {
-        item->setText(text.left(text.size() - 1));
-    }
-    modifiedItems_.remove(item);
+    model_->setModified(index, false);
 }
 
 QString JsonExplorerPage::prettyPrinted(const QJsonValue &value) const
@@ -1052,40 +1094,46 @@ void JsonExplorerPage::performFind(const QString &text, bool backward, bool wrap
     }
 }
 
-bool JsonExplorerPage::itemMatchesTreeSearch(QStandardItem *item, const QString &needle) const
+void JsonExplorerPage::startSearchIndexBuild()
 {
-    if (!item || needle.isEmpty()) {
-        return false;
-    }
-    QString label = item->text();
-    if (label.endsWith('*')) {
-        label.chop(1);
-    }
-    return label.toLower().contains(needle);
+    searchIndex_.reset();
+    pendingIndexUpdates_.clear();
+    treeSearchNeedle_.clear();
+    searchIndexWatcher_->setFuture(QtConcurrent::run(&JsonSearchIndex::build, losslessDoc_));
 }
 
-void JsonExplorerPage::collectTreeItems(QStandardItem *item, QList<QStandardItem *> &outItems)
+void JsonExplorerPage::updateSearchIndex(const QVariantList &path)
 {
-    if (!item) {
+    treeSearchNeedle_.clear();
+    if (searchIndexWatcher_->isRunning()) {
+        pendingIndexUpdates_.append(path);
         return;
     }
+    if (searchIndex_ && losslessDoc_) {
+        searchIndex_->update(*losslessDoc_, path);
+    }
+}
 
-    outItems.append(item);
-    QVariantList path = item->data(kPathRole).toList();
-    QJsonValue value = valueAtPath(path);
-    if (!item->data(kPopulatedRole).toBool() && (value.isObject() || value.isArray())) {
-        populateChildren(item);
-        item->setData(true, kPopulatedRole);
+bool JsonExplorerPage::selectPath(const QVariantList &path)
+{
+    QModelIndex targetIndex = model_->indexForPath(path);
+    if (!targetIndex.isValid()) {
+        return false;
     }
 
-    for (int row = 0; row < item->rowCount(); ++row) {
-        collectTreeItems(item->child(row), outItems);
+    QModelIndex parent = targetIndex.parent();
+    while (parent.isValid()) {
+        tree_->expand(parent);
+        parent = parent.parent();
     }
+    tree_->setCurrentIndex(targetIndex);
+    tree_->scrollTo(targetIndex, QAbstractItemView::PositionAtCenter);
+    return true;
 }
 
 void JsonExplorerPage::performTreeSearch(bool backward)
 {
-    if (!model_ || model_->rowCount() == 0) {
+    if (!losslessDoc_) {
         return;
     }
 
@@ -1094,27 +1142,22 @@ void JsonExplorerPage::performTreeSearch(bool backward)
         emit statusMessage(tr("Enter a node search term."));
         return;
     }
-
-    QStandardItem *root = model_->item(0, 0);
-    if (!root) {
-        return;
-    }
-
-    QList<QStandardItem *> allItems;
-    allItems.reserve(2048);
-    collectTreeItems(root, allItems);
-    if (allItems.isEmpty()) {
+    if (!searchIndex_) {
+        emit statusMessage(tr("Search index is still being built..."));
         return;
     }
 
-    QList<int> matchIndices;
-    matchIndices.reserve(allItems.size());
-    for (int i = 0; i < allItems.size(); ++i) {
-        if (itemMatchesTreeSearch(allItems.at(i), needle)) {
-            matchIndices.append(i);
+    if (needle != treeSearchNeedle_) {
+        treeSearchHits_ = searchIndex_->find(needle);
+        // The root is labelled with the file name, which the index does not know.
+        if (model_->label(model_->rootIndex()).toLower().contains(needle)
+            && (treeSearchHits_.isEmpty() || treeSearchHits_.first() != 0)) {
+            treeSearchHits_.prepend(0);
         }
+        treeSearchNeedle_ = needle;
     }
 
+    const QList<int> &matchIndices = treeSearchHits_;
     if (matchIndices.isEmpty()) {
         emit statusMessage(tr("No matching nodes for \"%1\"").arg(needle));
         return;
@@ -1123,52 +1166,98 @@ void JsonExplorerPage::performTreeSearch(bool backward)
     int currentPos = -1;
     QModelIndex currentIndex = tree_->currentIndex();
     if (currentIndex.isValid()) {
-        QStandardItem *current = model_->itemFromIndex(currentIndex);
-        currentPos = allItems.indexOf(current);
+        currentPos = searchIndex_->entryForPath(model_->pathForIndex(currentIndex));
     }
 
     int chosen = -1;
     if (backward) {
         for (int i = matchIndices.size() - 1; i >= 0; --i) {
             if (matchIndices.at(i) < currentPos) {
-                chosen = matchIndices.at(i);
+                chosen = i;
                 break;
             }
         }
         if (chosen < 0) {
-            chosen = matchIndices.last();
+            chosen = matchIndices.size() - 1;
         }
     } else {
         for (int i = 0; i < matchIndices.size(); ++i) {
             if (matchIndices.at(i) > currentPos) {
-                chosen = matchIndices.at(i);
+                chosen = i;
                 break;
             }
         }
         if (chosen < 0) {
-            chosen = matchIndices.first();
+            chosen = 0;
         }
     }
 
-    QStandardItem *target = allItems.value(chosen);
-    if (!target) {
+    if (!selectPath(searchIndex_->pathAt(matchIndices.at(chosen)))) {
         return;
     }
-
-    QModelIndex targetIndex = target->index();
-    QModelIndex parent = targetIndex.parent();
-    while (parent.isValid()) {
-        tree_->expand(parent);
-        parent = parent.parent();
-    }
-    tree_->setCurrentIndex(targetIndex);
-    tree_->scrollTo(targetIndex, QAbstractItemView::PositionAtCenter);
     emit statusMessage(tr("Node match %1/%2 for \"%3\"")
-                           .arg(matchIndices.indexOf(chosen) + 1)
+                           .arg(chosen + 1)
                            .arg(matchIndices.size())
                            .arg(needle));
 }
 
+void JsonExplorerPage::showSaveFindPanel()
+{
+    saveFindToggleButton_->setChecked(true);
+    saveFindField_->setFocus();
+    saveFindField_->selectAll();
+}
+
+void JsonExplorerPage::startSaveFind()
+{
+    if (!losslessDoc_) {
+        emit statusMessage(tr("No save loaded."));
+        return;
+    }
+
+    SaveSearchQuery query;
+    query.mode = static_cast<SaveSearchQuery::Mode>(saveFindMode_->currentData().toInt());
+    query.text = saveFindField_->text();
+    query.caseSensitive = saveFindCaseSensitive_->isChecked();
+    QString error;
+    if (!SaveSearch::validateQuery(query, &error)) {
+        emit statusMessage(error);
+        return;
+    }
+
+    // Commit first so the scan sees pending text and no write waits on its lock.
+    commitEditor();
+    stopSaveFind();
+    saveFindResults_->setRowCount(0);
+    saveFindButton_->setText(tr("Stop"));
+    emit statusMessage(tr("Searching save..."));
+    saveFindGeneration_ = losslessDoc_->generation();
+    saveFindWatcher_->setFuture(SaveSearch::start(losslessDoc_, query));
+}
+
+void JsonExplorerPage::stopSaveFind()
+{
+    if (saveFindWatcher_->isRunning()) {
+        saveFindWatcher_->cancel();
+    }
+    saveFindButton_->setText(tr("Find"));
+}
+
+void JsonExplorerPage::appendSaveFindResults(int begin, int end)
+{
+    saveFindResults_->setUpdatesEnabled(false);
+    for (int i = begin; i < end; ++i) {
+        const SaveSearchHit hit = saveFindWatcher_->resultAt(i);
+        const int row = saveFindResults_->rowCount();
+        saveFindResults_->insertRow(row);
+        auto *pathItem = new QTableWidgetItem(readablePath(hit.path));
+        pathItem->setData(kSaveFindPathRole, hit.path);
+        saveFindResults_->setItem(row, 0, pathItem);
+        saveFindResults_->setItem(row, 1, new QTableWidgetItem(hit.value));
+    }
+    saveFindResults_->setUpdatesEnabled(true);
+}
+
 void JsonExplorerPage::ensureMappingLoaded()
 {
     if (JsonMapper::isLoaded()) {
@@ -1178,12 +1267,7 @@ void JsonExplorerPage::ensureMappingLoaded()
     QString mappingPath = ResourceLocator::resolveResource(kMappingFile);
     qInfo() << "Loading mapping from" << mappingPath;
     JsonMapper::loadMapping(mappingPath);
-    reverseMapping_.clear();
-    QHash<QString, QString> map = JsonMapper::mapping();
-    qInfo() << "Mapping size:" << map.size();
-    for (auto it = map.begin(); it != map.end(); ++it) {
-        reverseMapping_.insert(it.value(), it.key());
-    }
+    qInfo() << "Mapping size:" << JsonMapper::size();
 }
 
 bool JsonExplorerPage::syncRootFromLossless(QString *errorMessage)
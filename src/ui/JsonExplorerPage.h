@@ -1,18 +1,25 @@
 #pragma once
 
+#include <QFutureWatcher>
 #include <QHash>
 #include <QJsonDocument>
-#include <QSet>
+#include <QPersistentModelIndex>
 #include <QVariant>
 #include <QWidget>
 #include <memory>
 
+#include "core/JsonPath.h"
+#include "core/JsonPrettyPager.h"
+#include "core/JsonSearchIndex.h"
 #include "core/LosslessJsonDocument.h"
+#include "core/SaveSearch.h"
 
+class JsonTreeModel;
+class QCheckBox;
+class QComboBox;
 class QPlainTextEdit;
 class QPushButton;
-class QStandardItem;
-class QStandardItemModel;
+class QTableWidget;
 class QTreeView;
 class QLineEdit;
 
@@ -39,30 +46,36 @@ public:
 
 signals:
     void statusMessage(const QString &message);
+    void documentEdited(const QVariantList &path);
 
 private:
     void buildTree();
-    void populateChildren(QStandardItem *parent);
-    void addPlaceholderIfNeeded(QStandardItem *item, const QJsonValue &value);
-    const rapidjson::Value *losslessValueAtPath(const QVariantList &path) const;
     QJsonValue valueAtPath(const QVariantList &path) const;
+    QJsonValue valueAtPath(const JsonPath &path) const;
     QJsonValue mapToReadable(const QJsonValue &value) const;
     QJsonValue remapToShort(const QJsonValue &value) const;
     QJsonValue setValueAtPath(const QJsonValue &root, const QVariantList &path, int depth, const QJsonValue &value) const;
     QString pathKey(const QVariantList &path) const;
-    QString displayPath(QStandardItem *item) const;
+    QString displayPath(const QModelIndex &index) const;
 
-    void loadEditorForItem(QStandardItem *item);
+    void loadEditorForIndex(const QModelIndex &index);
+    void appendEditorPage();
     bool commitEditor();
     QString prettyPrinted(const QJsonValue &value) const;
-    void markModified(QStandardItem *item);
-    void clearModified(QStandardItem *item);
+    void markModified(const QModelIndex &index);
+    void clearModified(const QModelIndex &index);
 
     void showFindDialog();
     void performFind(const QString &text, bool backward, bool wrap, bool caseSensitive, bool wholeWord, bool useRegex);
     void performTreeSearch(bool backward);
-    bool itemMatchesTreeSearch(QStandardItem *item, const QString &needle) const;
-    void collectTreeItems(QStandardItem *item, QList<QStandardItem *> &outItems);
+    void startSearchIndexBuild();
+    void updateSearchIndex(const QVariantList &path);
+    bool selectPath(const QVariantList &path);
+
+    void showSaveFindPanel();
+    void startSaveFind();
+    void stopSaveFind();
+    void appendSaveFindResults(int begin, int end);
 
     void ensureMappingLoaded();
     bool syncRootFromLossless(QString *errorMessage = nullptr);
@@ -71,18 +84,34 @@ private:
     QLineEdit *treeSearchField_ = nullptr;
     QPushButton *treeSearchPrevButton_ = nullptr;
     QPushButton *treeSearchNextButton_ = nullptr;
+    QPushButton *saveFindToggleButton_ = nullptr;
+    QWidget *saveFindPanel_ = nullptr;
+    QLineEdit *saveFindField_ = nullptr;
+    QComboBox *saveFindMode_ = nullptr;
+    QCheckBox *saveFindCaseSensitive_ = nullptr;
+    QPushButton *saveFindButton_ = nullptr;
+    QTableWidget *saveFindResults_ = nullptr;
+    QFutureWatcher<SaveSearchHit> *saveFindWatcher_ = nullptr;
+    quint64 saveFindGeneration_ = 0;
     QPlainTextEdit *editor_ = nullptr;
-    QStandardItemModel *model_ = nullptr;
+    JsonTreeModel *model_ = nullptr;
 
     QJsonDocument rootDoc_;
     std::shared_ptr<LosslessJsonDocument> losslessDoc_;
     QString currentFilePath_;
-    QStandardItem *currentItem_ = nullptr;
+    QPersistentModelIndex currentIndex_;
+    JsonPath currentPath_;
     bool ignoreEditorChange_ = false;
+    std::unique_ptr<JsonPrettyPager> editorPager_;
 
     QHash<QString, QJsonValue> originalValues_;
-    QSet<QStandardItem *> modifiedItems_;
-    QHash<QString, QString> reverseMapping_;
+    QHash<QString, quint64> originalHashes_;
+
+    std::shared_ptr<JsonSearchIndex> searchIndex_;
+    QFutureWatcher<std::shared_ptr<JsonSearchIndex>> *searchIndexWatcher_ = nullptr;
+    QList<QVariantList> pendingIndexUpdates_;
+    QString treeSearchNeedle_;
+    QList<int> treeSearchHits_;
 
     QString lastSearchText_;
     bool lastFindBackward_ = false;
@@ -0,0 +1,383 @@
+#include "ui/JsonTreeModel.h"
+
+#include "core/JsonMapper.h"
+
+namespace {
+int childCountOf(const rapidjson::Value *value)
+{
+    if (!value) {
+        return 0;
+    }
+    if (value->IsObject()) {
+        return static_cast<int>(value->MemberCount());
+    }
+    if (value->IsArray()) {
+        return static_cast<int>(value->Size());
+    }
+    return 0;
+}
+
+QString memberName(const rapidjson::Value &name)
+{
+    return QString::fromUtf8(name.GetString(), static_cast<int>(name.GetStringLength()));
+}
+}
+
+JsonTreeModel::JsonTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+    resetNodes();
+}
+
+void JsonTreeModel::setDocument(const std::shared_ptr<LosslessJsonDocument> &doc, const QString &rootLabel)
+{
+    beginResetModel();
+    doc_ = doc;
+    rootLabel_ = rootLabel;
+    resetNodes();
+    generation_ = doc_ ? doc_->generation() : 0;
+    endResetModel();
+}
+
+void JsonTreeModel::clear(const QString &placeholder)
+{
+    beginResetModel();
+    doc_.reset();
+    rootLabel_.clear();
+    placeholder_ = placeholder;
+    resetNodes();
+    endResetModel();
+}
+
+void JsonTreeModel::resetNodes()
+{
+    // Node 0 stands in for the invisible root; its only row is the document.
+    nodes_.clear();
+    Node root;
+    root.childCount = 1;
+    nodes_.append(root);
+    modifiedNodes_.clear();
+}
+
+QModelIndex JsonTreeModel::rootIndex() const
+{
+    return index(0, 0);
+}
+
+const rapidjson::Value *JsonTreeModel::childValue(int parentId, int row) const
+{
+    syncGeneration();
+    return resolveChild(parentId, row);
+}
+
+const rapidjson::Value *JsonTreeModel::resolveChild(int parentId, int row) const
+{
+    if (row < 0) {
+        return nullptr;
+    }
+    if (parentId == 0) {
+        return (row == 0 && doc_) ? &doc_->root() : nullptr;
+    }
+    const rapidjson::Value *parent = nodes_.at(parentId).value;
+    if (!parent) {
+        return nullptr;
+    }
+    if (parent->IsArray()) {
+        if (row >= static_cast<int>(parent->Size())) {
+            return nullptr;
+        }
+        return &(*parent)[static_cast<rapidjson::SizeType>(row)];
+    }
+    if (parent->IsObject()) {
+        if (row >= static_cast<int>(parent->MemberCount())) {
+            return nullptr;
+        }
+        return &(parent->MemberBegin() + row)->value;
+    }
+    return nullptr;
+}
+
+void JsonTreeModel::syncGeneration() const
+{
+    if (!doc_ || doc_->generation() == generation_) {
+        return;
+    }
+    generation_ = doc_->generation();
+    // Ids are handed out parent first, so one pass in id order re-resolves
+    // every parent before its children. Released nodes stay detached.
+    for (int id = 1; id < nodes_.size(); ++id) {
+        Node &node = nodes_[id];
+        if (node.parent < 0 || nodes_.at(node.parent).children.value(node.row, -1) != id) {
+            continue;
+        }
+        node.value = resolveChild(node.parent, node.row);
+    }
+}
+
+int JsonTreeModel::existingNodeId(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return 0;
+    }
+    const Node &parent = nodes_.at(static_cast<int>(index.internalId()));
+    return parent.children.value(index.row(), -1);
+}
+
+int JsonTreeModel::nodeId(const QModelIndex &index) const
+{
+    int existing = existingNodeId(index);
+    if (existing >= 0) {
+        return existing;
+    }
+    const int parentId = static_cast<int>(index.internalId());
+    Node node;
+    node.value = childValue(parentId, index.row());
+    node.parent = parentId;
+    node.row = index.row();
+    node.childCount = childCountOf(node.value);
+    const int id = nodes_.size();
+    nodes_.append(node);
+    nodes_[parentId].children.insert(index.row(), id);
+    return id;
+}
+
+QModelIndex JsonTreeModel::indexForNode(int id) const
+{
+    if (id <= 0 || id >= nodes_.size()) {
+        return QModelIndex();
+    }
+    const Node &node = nodes_.at(id);
+    return createIndex(node.row, 0, static_cast<quintptr>(node.parent));
+}
+
+const rapidjson::Value *JsonTreeModel::valueForIndex(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return nullptr;
+    }
+    syncGeneration();
+    int existing = existingNodeId(index);
+    if (existing >= 0) {
+        return nodes_.at(existing).value;
+    }
+    return childValue(static_cast<int>(index.internalId()), index.row());
+}
+
+QVariantList JsonTreeModel::pathForIndex(const QModelIndex &index) const
+{
+    syncGeneration();
+    QVariantList path;
+    QModelIndex current = index;
+    while (current.isValid() && current.internalId() != 0) {
+        const rapidjson::Value *parent = nodes_.at(static_cast<int>(current.internalId())).value;
+        if (parent && parent->IsObject() && current.row() < static_cast<int>(parent->MemberCount())) {
+            path.prepend(memberName((parent->MemberBegin() + current.row())->name));
+        } else {
+            path.prepend(current.row());
+        }
+        current = current.parent();
+    }
+    return path;
+}
+
+QModelIndex JsonTreeModel::indexForPath(const QVariantList &path) const
+{
+    QModelIndex current = rootIndex();
+    for (const QVariant &segment : path) {
+        const rapidjson::Value *value = valueForIndex(current);
+        if (!value) {
+            return QModelIndex();
+        }
+        int row = -1;
+        if (value->IsArray() && segment.canConvert<int>()) {
+            row = segment.toInt();
+        } else if (value->IsObject()) {
+            QByteArray key = segment.toString().toUtf8();
+            auto it = value->FindMember(rapidjson::StringRef(key.constData(),
+                                                             static_cast<rapidjson::SizeType>(key.size())));
+            if (it == value->MemberEnd()) {
+                return QModelIndex();
+            }
+            row = static_cast<int>(it - value->MemberBegin());
+        }
+        current = index(row, 0, current);
+        if (!current.isValid()) {
+            return QModelIndex();
+        }
+    }
+    return current;
+}
+
+QString JsonTreeModel::label(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return QString();
+    }
+    const int parentId = static_cast<int>(index.internalId());
+    if (parentId == 0) {
+        return doc_ ? rootLabel_ : placeholder_;
+    }
+    syncGeneration();
+    const rapidjson::Value *parent = nodes_.at(parentId).value;
+    if (parent && parent->IsObject() && index.row() < static_cast<int>(parent->MemberCount())) {
+        return JsonMapper::mapKey(memberName((parent->MemberBegin() + index.row())->name));
+    }
+    return QStringLiteral("[%1]").arg(index.row());
+}
+
+bool JsonTreeModel::isModified(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return false;
+    }
+    int existing = existingNodeId(index);
+    return existing >= 0 && modifiedNodes_.contains(existing);
+}
+
+void JsonTreeModel::setModified(const QModelIndex &index, bool modified)
+{
+    if (!index.isValid() || isModified(index) == modified) {
+        return;
+    }
+    const int id = nodeId(index);
+    if (modified) {
+        modifiedNodes_.insert(id);
+    } else {
+        modifiedNodes_.remove(id);
+    }
+    emit dataChanged(index, index, {Qt::DisplayRole});
+}
+
+void JsonTreeModel::clearModified()
+{
+    const QSet<int> nodes = modifiedNodes_;
+    modifiedNodes_.clear();
+    for (int id : nodes) {
+        QModelIndex index = indexForNode(id);
+        emit dataChanged(index, index, {Qt::DisplayRole});
+    }
+}
+
+void JsonTreeModel::refresh(const QModelIndex &index)
+{
+    if (!index.isValid()) {
+        return;
+    }
+    const int id = nodeId(index);
+    nodes_[id].value = childValue(nodes_.at(id).parent, nodes_.at(id).row);
+    refreshNode(id, index);
+    emit dataChanged(index, index);
+}
+
+void JsonTreeModel::refreshNode(int id, const QModelIndex &index)
+{
+    // Rows are positional, so a replaced value only needs its row count
+    // reconciled and every materialized descendant pointed at the new storage.
+    const int oldCount = nodes_.at(id).childCount;
+    const int newCount = childCountOf(nodes_.at(id).value);
+    if (newCount < oldCount) {
+        beginRemoveRows(index, newCount, oldCount - 1);
+        const QHash<int, int> children = nodes_.at(id).children;
+        for (auto it = children.cbegin(); it != children.cend(); ++it) {
+            if (it.key() >= newCount) {
+                releaseNode(it.value());
+                nodes_[id].children.remove(it.key());
+            }
+        }
+        nodes_[id].childCount = newCount;
+        endRemoveRows();
+    } else if (newCount > oldCount) {
+        beginInsertRows(index, oldCount, newCount - 1);
+        nodes_[id].childCount = newCount;
+        endInsertRows();
+    }
+
+    const QHash<int, int> children = nodes_.at(id).children;
+    for (auto it = children.cbegin(); it != children.cend(); ++it) {
+        nodes_[it.value()].value = childValue(id, it.key());
+        refreshNode(it.value(), createIndex(it.key(), 0, static_cast<quintptr>(id)));
+    }
+    if (newCount > 0) {
+        emit dataChanged(createIndex(0, 0, static_cast<quintptr>(id)),
+                         createIndex(newCount - 1, 0, static_cast<quintptr>(id)));
+    }
+}
+
+void JsonTreeModel::releaseNode(int id)
+{
+    // Released ids are never reused; the table only grows until the next reset.
+    modifiedNodes_.remove(id);
+    const QHash<int, int> children = nodes_.at(id).children;
+    for (int child : children) {
+        releaseNode(child);
+    }
+    nodes_[id].children.clear();
+    nodes_[id].value = nullptr;
+    nodes_[id].childCount = 0;
+}
+
+QModelIndex JsonTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column != 0 || row < 0) {
+        return QModelIndex();
+    }
+    if (parent.isValid() && !doc_) {
+        return QModelIndex();
+    }
+    const int parentId = nodeId(parent);
+    if (row >= nodes_.at(parentId).childCount) {
+        return QModelIndex();
+    }
+    return createIndex(row, 0, static_cast<quintptr>(parentId));
+}
+
+QModelIndex JsonTreeModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    return indexForNode(static_cast<int>(child.internalId()));
+}
+
+int JsonTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return 1;
+    }
+    if (!doc_) {
+        return 0;
+    }
+    return nodes_.at(nodeId(parent)).childCount;
+}
+
+int JsonTreeModel::columnCount(const QModelIndex &) const
+{
+    return 1;
+}
+
+bool JsonTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return true;
+    }
+    if (!doc_) {
+        return false;
+    }
+    int existing = existingNodeId(parent);
+    if (existing >= 0) {
+        return nodes_.at(existing).childCount > 0;
+    }
+    return childCountOf(childValue(static_cast<int>(parent.internalId()), parent.row())) > 0;
+}
+
+QVariant JsonTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    QString text = label(index);
+    if (isModified(index)) {
+        text.append('*');
+    }
+    return text;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QVariantList>
+#include <memory>
+
+#include "core/LosslessJsonDocument.h"
+
+// Tree model that reads the lossless document in place. An index is a row plus
+// the id of its parent node, and node ids are only handed out for rows that the
+// view uses as a parent or that get selected, so expanding a large container
+// costs nothing beyond the rows that are actually painted. Cached node pointers
+// are re-resolved by position whenever the document generation moves, since
+// edits from anywhere can move or free them.
+class JsonTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    explicit JsonTreeModel(QObject *parent = nullptr);
+
+    void setDocument(const std::shared_ptr<LosslessJsonDocument> &doc, const QString &rootLabel);
+    void clear(const QString &placeholder);
+
+    QModelIndex rootIndex() const;
+    const rapidjson::Value *valueForIndex(const QModelIndex &index) const;
+    QVariantList pathForIndex(const QModelIndex &index) const;
+    QModelIndex indexForPath(const QVariantList &path) const;
+    QString label(const QModelIndex &index) const;
+
+    bool isModified(const QModelIndex &index) const;
+    void setModified(const QModelIndex &index, bool modified);
+    bool hasModified() const { return !modifiedNodes_.isEmpty(); }
+    void clearModified();
+
+    // Re-reads the subtree under index after its value was replaced in place.
+    void refresh(const QModelIndex &index);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Node {
+        const rapidjson::Value *value = nullptr;
+        int parent = -1;
+        int row = 0;
+        int childCount = 0;
+        QHash<int, int> children;
+    };
+
+    int nodeId(const QModelIndex &index) const;
+    int existingNodeId(const QModelIndex &index) const;
+    QModelIndex indexForNode(int id) const;
+    const rapidjson::Value *childValue(int parentId, int row) const;
+    const rapidjson::Value *resolveChild(int parentId, int row) const;
+    void syncGeneration() const;
+    void resetNodes();
+    void refreshNode(int id, const QModelIndex &index);
+    void releaseNode(int id);
+
+    std::shared_ptr<LosslessJsonDocument> doc_;
+    QString rootLabel_;
+    QString placeholder_;
+    mutable QList<Node> nodes_;
+    mutable quint64 generation_ = 0;
+    QSet<int> modifiedNodes_;
+};
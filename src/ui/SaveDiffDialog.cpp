@@ -0,0 +1,112 @@
+#include "ui/SaveDiffDialog.h"
+
+#include "core/JsonMapper.h"
+#include "core/LosslessJsonDocument.h"
+
+#include <QDialogButtonBox>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+namespace {
+constexpr int kColumnKind = 0;
+constexpr int kColumnPath = 1;
+constexpr int kColumnBefore = 2;
+constexpr int kColumnAfter = 3;
+constexpr int kColumnCount = 4;
+
+QString readablePath(const QVariantList &path)
+{
+    QStringList parts;
+    for (const QVariant &segment : path) {
+        if (segment.typeId() == QMetaType::QString) {
+            parts << JsonMapper::mapKey(segment.toString());
+        } else {
+            parts << QString("[%1]").arg(segment.toInt());
+        }
+    }
+    return parts.join("/");
+}
+}
+
+SaveDiffDialog::SaveDiffDialog(const QString &beforePath, const QString &afterPath,
+                               const std::shared_ptr<LosslessJsonDocument> &afterDoc,
+                               QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Compare %1 with %2")
+                       .arg(QFileInfo(beforePath).fileName(), QFileInfo(afterPath).fileName()));
+    resize(900, 560);
+
+    auto *layout = new QVBoxLayout(this);
+    summaryLabel_ = new QLabel(tr("Comparing saves..."), this);
+    layout->addWidget(summaryLabel_);
+
+    table_ = new QTableWidget(this);
+    table_->setColumnCount(kColumnCount);
+    table_->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table_->setSelectionMode(QAbstractItemView::SingleSelection);
+    table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table_->setHorizontalHeaderLabels(QStringList()
+        << tr("Change") << tr("Path") << QFileInfo(beforePath).fileName() << QFileInfo(afterPath).fileName());
+    table_->horizontalHeader()->setStretchLastSection(true);
+    table_->verticalHeader()->setVisible(false);
+    layout->addWidget(table_, 1);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    connect(&watcher_, &QFutureWatcher<SaveDiffResult>::finished, this, [this]() {
+        showResult(watcher_.result());
+    });
+    watcher_.setFuture(QtConcurrent::run(&SaveDiff::compareFiles, beforePath, afterPath, afterDoc));
+}
+
+void SaveDiffDialog::showResult(const SaveDiffResult &result)
+{
+    if (!result.errorMessage.isEmpty()) {
+        summaryLabel_->setText(result.errorMessage);
+        return;
+    }
+
+    int added = 0;
+    int removed = 0;
+    int changed = 0;
+    table_->setUpdatesEnabled(false);
+    table_->setRowCount(result.changes.size());
+    for (int row = 0; row < result.changes.size(); ++row) {
+        const SaveDiffChange &change = result.changes.at(row);
+        switch (change.kind) {
+        case SaveDiffChange::Kind::Added:
+            ++added;
+            break;
+        case SaveDiffChange::Kind::Removed:
+            ++removed;
+            break;
+        case SaveDiffChange::Kind::Changed:
+            ++changed;
+            break;
+        }
+        table_->setItem(row, kColumnKind, new QTableWidgetItem(SaveDiff::kindLabel(change.kind)));
+        table_->setItem(row, kColumnPath, new QTableWidgetItem(readablePath(change.path)));
+        table_->setItem(row, kColumnBefore, new QTableWidgetItem(change.before));
+        table_->setItem(row, kColumnAfter, new QTableWidgetItem(change.after));
+    }
+    table_->resizeColumnToContents(kColumnKind);
+    table_->setColumnWidth(kColumnPath, 360);
+    table_->setUpdatesEnabled(true);
+
+    if (result.changes.isEmpty()) {
+        summaryLabel_->setText(tr("The saves are identical."));
+        return;
+    }
+    QString summary = tr("%1 changed, %2 added, %3 removed.").arg(changed).arg(added).arg(removed);
+    if (result.truncated) {
+        summary += QLatin1Char(' ') + tr("Only the first %1 differences are listed.").arg(SaveDiff::kMaxChanges);
+    }
+    summaryLabel_->setText(summary);
+}
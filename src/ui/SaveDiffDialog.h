@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <memory>
+
+#include "core/SaveDiff.h"
+
+class QLabel;
+class QTableWidget;
+
+class SaveDiffDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // Compares beforePath against afterPath, or against afterDoc when the
+    // after side is already loaded (for example the current session).
+    SaveDiffDialog(const QString &beforePath, const QString &afterPath,
+                   const std::shared_ptr<LosslessJsonDocument> &afterDoc = nullptr,
+                   QWidget *parent = nullptr);
+
+private:
+    void showResult(const SaveDiffResult &result);
+
+    QLabel *summaryLabel_ = nullptr;
+    QTableWidget *table_ = nullptr;
+    QFutureWatcher<SaveDiffResult> watcher_;
+};
@@ -408,10 +408,12 @@ WelcomePage::WelcomePage(QWidget *parent)
         SaveSlot slot = selectedSlot();
         updateSaveFilesTable(slot);
         updateButtonState();
+        emit selectionChanged();
     });
     connect(saveTable_, &QTableWidget::cellClicked, this, [this](int row, int) {
         updateSaveSelection(row);
         updateButtonState();
+        emit selectionChanged();
     });
 
     updateButtonState();
@@ -682,6 +684,7 @@ void WelcomePage::setLoadedSavePath(const QString &path)
         updateSaveFilesTable(selectedSlot());
     }
     updateButtonState();
+    emit selectionChanged();
 }
 
 void WelcomePage::setSyncState(bool pending, bool applied)
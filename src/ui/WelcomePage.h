@@ -32,6 +32,7 @@ signals:
     void saveChangesRequested();
     void syncOtherSaveRequested();
     void undoSyncRequested();
+    void selectionChanged();
 
 private:
     void updateButtonState();